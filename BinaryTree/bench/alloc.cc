@@ -0,0 +1,135 @@
+/**@file alloc.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Compares BinTree (nodes from a per-tree NodePool) with std::set (one heap
+allocation per node) on the work that depends on how nodes are allocated:
+building a tree, searching it, removing half of it and rebuilding (freelist
+reuse), and throwing it away. Both are red-black trees, so the shapes match.
+Outputs CSV to the file given as the first argument (alloc.csv by default).
+
+                   , 10000, 100000, 1000000
+    BINTREE BUILD  , 0.0007, ...
+    BINTREE SEARCH , ...
+    BINTREE CHURN  , ...
+    BINTREE ERASE  , ...
+    STD::SET BUILD , ...
+
+Every value is the time in seconds for the whole phase.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "BinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+
+enum Phase {BUILD, SEARCH, CHURN, ERASE};
+const int phaseCount = 4;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+/**@brief times each phase on a BinTree<uint64_t>
+   @param keys the keys to insert, in insertion order
+   @param times set to the time each Phase took
+*/
+void timeBinTree(const vector<uint64_t>& keys, double times[]) {
+    BinTree<uint64_t> tree(RED_BLACK);
+    uint64_t found = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (uint64_t k : keys)
+        tree.insert(k);
+    times[BUILD] = since(start);
+
+    start = chrono::steady_clock::now();
+    for (uint64_t k : keys)
+        found += tree.search(k).first;
+    times[SEARCH] = since(start);
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i += 2)
+        tree.remove(keys[i]);
+    for (size_t i = 0; i < keys.size(); i += 2)
+        tree.insert(keys[i]);
+    times[CHURN] = since(start);
+
+    start = chrono::steady_clock::now();
+    tree.erase();
+    times[ERASE] = since(start);
+
+    if (found != keys.size())
+        cerr << "BinTree lost keys" << endl;
+}
+
+///@brief times each phase on a std::set<uint64_t>, see timeBinTree()
+void timeStdSet(const vector<uint64_t>& keys, double times[]) {
+    set<uint64_t> tree;
+    uint64_t found = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (uint64_t k : keys)
+        tree.insert(k);
+    times[BUILD] = since(start);
+
+    start = chrono::steady_clock::now();
+    for (uint64_t k : keys)
+        found += tree.count(k);
+    times[SEARCH] = since(start);
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i += 2)
+        tree.erase(keys[i]);
+    for (size_t i = 0; i < keys.size(); i += 2)
+        tree.insert(keys[i]);
+    times[CHURN] = since(start);
+
+    start = chrono::steady_clock::now();
+    tree.clear();
+    times[ERASE] = since(start);
+
+    if (found != keys.size())
+        cerr << "std::set lost keys" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "alloc.csv" : argv[1]);
+    const string phaseStr[] = {"BUILD", "SEARCH", "CHURN", "ERASE"};
+    vector<string> binRows(phaseCount), setRows(phaseCount);
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        vector<uint64_t> keys(size);
+        for (uint32_t i = 0; i < size; i++)
+            keys[i] = i;
+        shuffle(keys.begin(), keys.end(), mt19937(42));
+
+        double binTimes[phaseCount], setTimes[phaseCount];
+        timeBinTree(keys, binTimes);
+        timeStdSet(keys, setTimes);
+        for (int p = 0; p < phaseCount; p++)
+        {
+            binRows[p] += to_string(binTimes[p]) + ",";
+            setRows[p] += to_string(setTimes[p]) + ",";
+        }
+    }
+
+    for (int p = 0; p < phaseCount; p++)
+        out << endl << "BINTREE " << phaseStr[p] << "," << binRows[p];
+    for (int p = 0; p < phaseCount; p++)
+        out << endl << "STD::SET " << phaseStr[p] << "," << setRows[p];
+    out << endl;
+}
@@ -0,0 +1,112 @@
+/**@file batch.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Compares searching and inserting one key at a time against searchBatch() and
+insertBatch(), on RED_BLACK trees of uint64_t keys inserted in random order.
+The largest tree (40 MB of nodes) is bigger than the last-level cache of most
+machines, which is where batching is meant to help.
+- SEARCH: lookupCount random keys, half of them missing, one search() each
+- SEARCH BATCH: the same keys, batchSize keys per searchBatch()
+- INSERT: insertCount new random keys, one insert() each
+- INSERT BATCH: the same keys, batchSize keys per insertBatch()
+Outputs CSV to the file given as the first argument (batch.csv by default).
+
+                 , 10000, 100000, 1000000
+    SEARCH       , 0.1016, ...
+    SEARCH BATCH , ...
+    INSERT       , ...
+    INSERT BATCH , ...
+
+Every value is the time in seconds for the whole phase.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "BinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t lookupCount = 1000000; ///<The number of keys to search for
+const uint32_t insertCount = 100000; ///<The number of keys to insert
+const uint32_t batchSize = 4096; ///<The number of keys in each batch
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "batch.csv" : argv[1]);
+    string searchRow, searchBatchRow, insertRow, insertBatchRow;
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        vector<uint64_t> keys(size);
+        for (uint32_t i = 0; i < size; i++)
+            keys[i] = 2 * i;
+        shuffle(keys.begin(), keys.end(), mt19937(42));
+        BinTree<uint64_t> tree(RED_BLACK);
+        for (uint64_t k : keys)
+            tree.insert(k);
+
+        mt19937_64 rng(7);
+        vector<uint64_t> lookups(lookupCount);
+        for (uint64_t& k : lookups)
+            k = rng() % (2 * size);
+
+        uint64_t found[2] = {0, 0};
+        auto start = chrono::steady_clock::now();
+        for (uint64_t k : lookups)
+            found[0] += tree.search(k).first;
+        searchRow += to_string(since(start)) + ",";
+
+        vector<BinTree<uint64_t>::iterator> results(batchSize);
+        start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < lookupCount; i += batchSize)
+        {
+            uint32_t n = min(batchSize, lookupCount - i);
+            tree.searchBatch(lookups.begin() + i, lookups.begin() + i + n,
+                             results.begin());
+            for (uint32_t r = 0; r < n; r++)
+                found[1] += (results[r] != tree.end());
+        }
+        searchBatchRow += to_string(since(start)) + ",";
+        if (found[0] != found[1])
+            cerr << "The searches disagree at size " << size << endl;
+
+        //odd keys are all new
+        vector<uint64_t> inserts(insertCount);
+        for (uint64_t& k : inserts)
+            k = 2 * (rng() % (size * 8)) + 1;
+
+        BinTree<uint64_t> copy(tree);
+        start = chrono::steady_clock::now();
+        for (uint64_t k : inserts)
+            tree.insert(k);
+        insertRow += to_string(since(start)) + ",";
+
+        start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < insertCount; i += batchSize)
+        {
+            uint32_t n = min(batchSize, insertCount - i);
+            copy.insertBatch(inserts.begin() + i, inserts.begin() + i + n);
+        }
+        insertBatchRow += to_string(since(start)) + ",";
+        if (tree.count() != copy.count())
+            cerr << "The inserts disagree at size " << size << endl;
+    }
+
+    out << endl << "SEARCH," << searchRow
+        << endl << "SEARCH BATCH," << searchBatchRow
+        << endl << "INSERT," << insertRow
+        << endl << "INSERT BATCH," << insertBatchRow << endl;
+}
@@ -0,0 +1,138 @@
+/**@file bloom.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Measures what enableFilter() buys a RED_BLACK BinTree when most lookups
+miss. Each tree holds size random keys, then searches for lookupCount keys
+of which 80% are not in the tree, once without a filter and once with a 1%
+filter.
+Outputs CSV to the file given as the first argument (bloom.csv by default).
+
+                       , 10000, 100000, 1000000
+    SEARCH             , 0.106, ...
+    SEARCH FILTERED    , ...
+    FALSE POSITIVES    , 0.0001, ...
+    FILTER BYTES/KEY   , ...
+    SPLIT FILTERED     , ...
+
+SEARCH rows are in seconds for all the lookups. FALSE POSITIVES is the share
+of misses that the filter let through to the tree, measured on a separate
+BloomFilter sized and filled the way the tree's is (the tree only counts them
+with BINTREE_STATS). FILTER BYTES/KEY is the memory the filter takes divided
+by the number of items. The filter is sized for twice the items it holds, so
+it does better than the 1% asked for, at about twice the memory.
+
+SPLIT FILTERED removes and puts back a quarter of the keys (so the filter
+holds more keys than the tree), then times split() keeping the lower 40%,
+and checks that every key is still found on its side. Exits with 1 if any
+search gives the wrong answer.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <functional>
+#include "BinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t lookupCount = 1000000; ///<The number of searches to time
+const uint32_t missPercent = 80; ///<The share of searches that miss
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+///@brief searches for every key, returns the number found
+uint64_t searchAll(BinTree<uint64_t>& tree, const vector<uint64_t>& keys) {
+    uint64_t found = 0;
+    for (uint64_t k : keys)
+        found += tree.search(k).first;
+    return found;
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "bloom.csv" : argv[1]);
+    string rows[5];
+    int status = 0;
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        //even keys are in the tree, odd keys never are
+        vector<uint64_t> keys(size);
+        for (uint32_t i = 0; i < size; i++)
+            keys[i] = 2 * i;
+        shuffle(keys.begin(), keys.end(), mt19937(42));
+        mt19937_64 rng(7);
+        vector<uint64_t> lookups(lookupCount);
+        for (uint64_t& k : lookups)
+            k = 2 * (rng() % size) + (rng() % 100 < missPercent);
+
+        BinTree<uint64_t> tree(RED_BLACK);
+        for (uint64_t k : keys)
+            tree.insert(k);
+
+        auto start = chrono::steady_clock::now();
+        const uint64_t found = searchAll(tree, lookups);
+        rows[0] += to_string(since(start)) + ",";
+
+        tree.enableFilter(0.01);
+        start = chrono::steady_clock::now();
+        const uint64_t filteredFound = searchAll(tree, lookups);
+        rows[1] += to_string(since(start)) + ",";
+
+        BloomFilter filter;
+        filter.resize(2 * static_cast<uint64_t>(size), 0.01);
+        for (uint64_t k : keys)
+            filter.add(hash<uint64_t>()(k));
+        uint64_t passed = 0;
+        for (uint64_t k : lookups)
+            passed += filter.mayContain(hash<uint64_t>()(k));
+        const uint64_t misses = lookupCount - found;
+        rows[2] += to_string(1.0 * (passed - found) / misses) + ",";
+        rows[3] += to_string(1.0 * tree.stats().filterBytes / size) + ",";
+
+        //the filter now holds 25% more keys than the tree, and the bigger
+        //side of the split stays in this tree's pool
+        for (uint32_t i = 0; i < size / 4; i++)
+        {
+            tree.remove(keys[i]);
+            tree.insert(keys[i]);
+        }
+        const uint64_t cut = 2 * (size / 5 * 2);
+        start = chrono::steady_clock::now();
+        BinTree<uint64_t> upper = tree.split(cut);
+        rows[4] += to_string(since(start)) + ",";
+        uint64_t kept = 0;
+        for (uint64_t k : keys)
+            kept += (k < cut ? tree : upper).search(k).first;
+
+        if (found != filteredFound)
+        {
+            cerr << "The filter changed the results at size " << size << endl;
+            status = 1;
+        }
+        if (kept != size)
+        {
+            cerr << "split() lost " << size - kept << " keys at size " << size
+                 << endl;
+            status = 1;
+        }
+        cout << "Finished size " << size << "." << endl;
+    }
+
+    const string rowStr[] = {"SEARCH", "SEARCH FILTERED", "FALSE POSITIVES",
+                             "FILTER BYTES/KEY", "SPLIT FILTERED"};
+    for (int r = 0; r < 5; r++)
+        out << endl << rowStr[r] << "," << rows[r];
+    out << endl;
+    return status;
+}
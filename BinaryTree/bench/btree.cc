@@ -0,0 +1,176 @@
+/**@file btree.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Compares BTree (many keys per node) with BinTree (RED_BLACK) and std::set
+(1 key per node) on uint64_t keys inserted in random order:
+- INSERT: build the tree
+- LOOKUP: search for every key, and as many keys that are missing
+- SCAN: read 1000 ranges of 100 keys each, starting at random keys
+- MIXED: 50% lookups, 25% inserts and 25% removes of random keys
+Outputs CSV to the file given as the first argument (btree.csv by default).
+
+                   , 10000, 100000, 1000000
+    BTREE INSERT   , 0.0005, ...
+    BTREE LOOKUP   , ...
+    BTREE SCAN     , ...
+    BTREE MIXED    , ...
+    BINTREE INSERT , ...
+
+Every value is the time in seconds for the whole phase.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "BinTree.hh"
+#include "BTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t scanCount = 1000; ///<The number of ranges to read
+const uint32_t scanLength = 100; ///<The number of keys in each range
+
+enum Phase {INSERT, LOOKUP, SCAN, MIXED};
+const int phaseCount = 4;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+//the same operations on each kind of tree
+void add(BTree<uint64_t>& tree, uint64_t k) { tree.insert(k); }
+void add(BinTree<uint64_t>& tree, uint64_t k) { tree.insert(k); }
+void add(set<uint64_t>& tree, uint64_t k) { tree.insert(k); }
+bool has(const BTree<uint64_t>& tree, uint64_t k) {
+    return tree.search(k).first;
+}
+bool has(BinTree<uint64_t>& tree, uint64_t k) {
+    return tree.search(k).first;
+}
+bool has(const set<uint64_t>& tree, uint64_t k) { return tree.count(k); }
+void drop(BTree<uint64_t>& tree, uint64_t k) { tree.remove(k); }
+void drop(BinTree<uint64_t>& tree, uint64_t k) { tree.remove(k); }
+void drop(set<uint64_t>& tree, uint64_t k) { tree.erase(k); }
+
+///@brief adds up the keys from low to high
+template<class Tree>
+uint64_t scan(const Tree& tree, uint64_t low, uint64_t high) {
+    uint64_t sum = 0;
+    for (uint64_t k : tree.range(low, high))
+        sum += k;
+    return sum;
+}
+uint64_t scan(const set<uint64_t>& tree, uint64_t low, uint64_t high) {
+    uint64_t sum = 0;
+    for (auto i = tree.lower_bound(low), last = tree.upper_bound(high);
+         i != last; ++i)
+        sum += *i;
+    return sum;
+}
+
+/**@brief times each phase on one kind of tree
+   @param tree an empty tree
+   @param keys the keys to insert, in insertion order (the even numbers from
+               0 to 2 * size, so the odd numbers are missing)
+   @param times set to the time each Phase took
+   @return a checksum, so that the work is not optimized away
+*/
+template<class Tree>
+uint64_t timeTree(Tree& tree, const vector<uint64_t>& keys, double times[]) {
+    uint64_t check = 0;
+    mt19937_64 rng(7);
+
+    auto start = chrono::steady_clock::now();
+    for (uint64_t k : keys)
+        add(tree, k);
+    times[INSERT] = since(start);
+
+    start = chrono::steady_clock::now();
+    for (uint64_t k : keys)
+        check += has(tree, k) + has(tree, k + 1);
+    times[LOOKUP] = since(start);
+
+    start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < scanCount; i++)
+    {
+        uint64_t low = keys[rng() % keys.size()];
+        check += scan(tree, low, low + 2 * scanLength);
+    }
+    times[SCAN] = since(start);
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        uint64_t k = rng() % (2 * keys.size());
+        switch (rng() % 4)
+        {
+        case 0:
+            add(tree, k);
+            break;
+        case 1:
+            drop(tree, k);
+            break;
+        default:
+            check += has(tree, k);
+        }
+    }
+    times[MIXED] = since(start);
+    return check;
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "btree.csv" : argv[1]);
+    const string phaseStr[] = {"INSERT", "LOOKUP", "SCAN", "MIXED"};
+    const string treeStr[] = {"BTREE", "BINTREE", "STD::SET"};
+    const int treeCount = 3;
+    vector<string> rows(treeCount * phaseCount);
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        vector<uint64_t> keys(size);
+        for (uint32_t i = 0; i < size; i++)
+            keys[i] = 2 * i;
+        shuffle(keys.begin(), keys.end(), mt19937(42));
+
+        double times[treeCount][phaseCount];
+        uint64_t check[treeCount];
+        {
+            BTree<uint64_t> tree;
+            check[0] = timeTree(tree, keys, times[0]);
+        }
+        {
+            BinTree<uint64_t> tree(RED_BLACK);
+            check[1] = timeTree(tree, keys, times[1]);
+        }
+        {
+            set<uint64_t> tree;
+            check[2] = timeTree(tree, keys, times[2]);
+        }
+        if (check[0] != check[2] || check[1] != check[2])
+            cerr << "The trees disagree at size " << size << endl;
+
+        for (int t = 0; t < treeCount; t++)
+        {
+            for (int p = 0; p < phaseCount; p++)
+                rows[t * phaseCount + p] += to_string(times[t][p]) + ",";
+        }
+    }
+
+    for (int t = 0; t < treeCount; t++)
+    {
+        for (int p = 0; p < phaseCount; p++)
+            out << endl << treeStr[t] << " " << phaseStr[p] << ","
+                << rows[t * phaseCount + p];
+    }
+    out << endl;
+}
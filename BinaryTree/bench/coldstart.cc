@@ -0,0 +1,119 @@
+/**@file coldstart.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Compares the ways to get a RED_BLACK tree ready for lookups at startup:
+- INSERT: insert every key, in random order (no tree file)
+- SAVE: write the tree to a tree file with saveTree()
+- LOAD: rebuild the tree from the file with loadTree()
+- MAPPED: open the file as a MappedBinTree and do firstLookups searches
+Both uint64_t keys and std::string keys (the same numbers, as text) are
+timed. The file was just written, so it is in the page cache: the times are
+for a warm disk cache, without the time to read the file from disk.
+Outputs CSV to the file given as the first argument (coldstart.csv by
+default). The tree file is written to coldstart.tree and removed at the end.
+
+                  , 10000, 100000, 1000000
+    UINT64 INSERT , 0.0007, ...
+    UINT64 SAVE   , ...
+    UINT64 LOAD   , ...
+    UINT64 MAPPED , ...
+    STRING INSERT , ...
+
+Every value is the time in seconds.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include "BinTree.hh"
+#include "MappedBinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t firstLookups = 1000; ///<Searches done on the mapped file
+const char* const treeFile = "coldstart.tree";
+
+enum Phase {INSERT, SAVE, LOAD, MAPPED};
+const int phaseCount = 4;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+/**@brief times each Phase for one key type
+   @param keys the keys, in random order
+   @param times set to the time each Phase took
+   @return false if anything failed
+*/
+template<class Key>
+bool timeStartup(const vector<Key>& keys, double times[]) {
+    auto start = chrono::steady_clock::now();
+    BinTree<Key> tree(RED_BLACK);
+    for (const Key& k : keys)
+        tree.insert(k);
+    times[INSERT] = since(start);
+
+    start = chrono::steady_clock::now();
+    bool ok = saveTree(treeFile, tree);
+    times[SAVE] = since(start);
+
+    start = chrono::steady_clock::now();
+    BinTree<Key> loaded(RED_BLACK);
+    ok = ok && loadTree(treeFile, loaded);
+    times[LOAD] = since(start);
+
+    start = chrono::steady_clock::now();
+    MappedBinTree<Key> mapped;
+    ok = ok && mapped.open(treeFile);
+    uint32_t found = 0;
+    for (uint32_t i = 0; i < firstLookups && i < keys.size(); i++)
+        found += mapped.contains(keys[i]);
+    times[MAPPED] = since(start);
+
+    return ok && loaded.count() == tree.count() &&
+           found == min<size_t>(firstLookups, keys.size());
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "coldstart.csv" : argv[1]);
+    const string phaseStr[] = {"INSERT", "SAVE", "LOAD", "MAPPED"};
+    vector<string> numberRows(phaseCount), stringRows(phaseCount);
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        vector<uint64_t> numbers(size);
+        for (uint32_t i = 0; i < size; i++)
+            numbers[i] = i;
+        shuffle(numbers.begin(), numbers.end(), mt19937(42));
+        vector<string> strings;
+        for (uint64_t k : numbers)
+            strings.push_back(to_string(k));
+
+        double numberTimes[phaseCount], stringTimes[phaseCount];
+        if (!timeStartup(numbers, numberTimes) ||
+            !timeStartup(strings, stringTimes))
+            cerr << "Saving or loading failed at size " << size << endl;
+        for (int p = 0; p < phaseCount; p++)
+        {
+            numberRows[p] += to_string(numberTimes[p]) + ",";
+            stringRows[p] += to_string(stringTimes[p]) + ",";
+        }
+    }
+    remove(treeFile);
+
+    for (int p = 0; p < phaseCount; p++)
+        out << endl << "UINT64 " << phaseStr[p] << "," << numberRows[p];
+    for (int p = 0; p < phaseCount; p++)
+        out << endl << "STRING " << phaseStr[p] << "," << stringRows[p];
+    out << endl;
+}
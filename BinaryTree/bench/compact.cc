@@ -0,0 +1,130 @@
+/**@file compact.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Compares a CompactBinTree with a RED_BLACK BinTree holding the same random
+keys. Each tree inserts size keys in random order, searches for lookupCount
+random keys (half of them missing), walks every item in order, then removes
+every key in a different random order.
+Outputs CSV to the file given as the first argument (compact.csv by
+default).
+
+                       , 10000, 100000, 1000000
+    BINTREE INSERT     , 0.0011, ...
+    BINTREE SEARCH     , ...
+    BINTREE SCAN       , ...
+    BINTREE REMOVE     , ...
+    BINTREE BYTES/NODE , 40, ...
+    COMPACT INSERT     , ...
+    ...
+    COMPACT BYTES/NODE , 16, ...
+
+Time rows are in seconds for the whole phase. BYTES/NODE is the memory taken
+by the nodes divided by the number of items, which for CompactBinTree
+includes the room its array has left to grow.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "BinTree.hh"
+#include "CompactBinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t lookupCount = 1000000; ///<The number of searches to time
+
+enum Phase {INSERT, SEARCH, SCAN, REMOVE, BYTES};
+const int phaseCount = 5;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+///@brief the bytes taken by a BinTree's nodes
+size_t nodeBytes(const BinTree<uint64_t>& tree) {
+    return tree.count() * sizeof(Node<uint64_t>);
+}
+
+///@brief the bytes taken by a CompactBinTree's array
+size_t nodeBytes(const CompactBinTree<uint64_t>& tree) {
+    return tree.memory();
+}
+
+/**@brief runs every phase on one tree
+   @param tree an empty tree
+   @param rows one row per Phase, each gets a value appended
+   @return a checksum of what the searches and the scan saw
+*/
+template<class Tree>
+uint64_t run(Tree& tree, const vector<uint64_t>& keys,
+             const vector<uint64_t>& lookups,
+             const vector<uint64_t>& removals, string rows[]) {
+    auto start = chrono::steady_clock::now();
+    for (uint64_t k : keys)
+        tree.insert(k);
+    rows[INSERT] += to_string(since(start)) + ",";
+
+    uint64_t sum = 0;
+    start = chrono::steady_clock::now();
+    for (uint64_t k : lookups)
+        sum += tree.search(k).first;
+    rows[SEARCH] += to_string(since(start)) + ",";
+
+    start = chrono::steady_clock::now();
+    for (uint64_t k : tree)
+        sum += k;
+    rows[SCAN] += to_string(since(start)) + ",";
+    rows[BYTES] += to_string(nodeBytes(tree) / keys.size()) + ",";
+
+    start = chrono::steady_clock::now();
+    for (uint64_t k : removals)
+        tree.remove(k);
+    rows[REMOVE] += to_string(since(start)) + ",";
+    if (tree.count() != 0)
+        cerr << "Keys were left behind at size " << keys.size() << endl;
+    return sum;
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "compact.csv" : argv[1]);
+    const string phaseStr[] = {"INSERT", "SEARCH", "SCAN", "REMOVE",
+                               "BYTES/NODE"};
+    string treeRows[phaseCount], compactRows[phaseCount];
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        //even keys are in the trees, odd keys never are
+        vector<uint64_t> keys(size);
+        for (uint32_t i = 0; i < size; i++)
+            keys[i] = 2 * i;
+        shuffle(keys.begin(), keys.end(), mt19937(42));
+        vector<uint64_t> removals(keys);
+        shuffle(removals.begin(), removals.end(), mt19937(3));
+        vector<uint64_t> lookups(lookupCount);
+        mt19937_64 rng(7);
+        for (uint64_t& k : lookups)
+            k = rng() % (2 * size);
+
+        BinTree<uint64_t> tree(RED_BLACK);
+        CompactBinTree<uint64_t> compact;
+        if (run(tree, keys, lookups, removals, treeRows) !=
+            run(compact, keys, lookups, removals, compactRows))
+            cerr << "The trees disagree at size " << size << endl;
+        cout << "Finished size " << size << "." << endl;
+    }
+
+    for (int p = 0; p < phaseCount; p++)
+        out << endl << "BINTREE " << phaseStr[p] << "," << treeRows[p];
+    for (int p = 0; p < phaseCount; p++)
+        out << endl << "COMPACT " << phaseStr[p] << "," << compactRows[p];
+    out << endl;
+}
@@ -0,0 +1,213 @@
+/**@file concurrent.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Stress tests ConcurrentBinTree, then measures its throughput against a
+BinTree (RED_BLACK) behind one global mutex, the way a tree was shared before.
+
+The stress test fills the tree with the even numbers below 2 * treeSize, then
+writer threads insert and remove odd numbers while reader threads check that
+every even number can always be found. Afterwards, the tree must still be in
+order and hold count() items. Errors are counted in the STRESS ERRORS row
+(and reported on cerr).
+
+The throughput runs use 1 to 32 threads, each doing opsPerThread operations
+on random keys below 2 * treeSize, with 100/0, 95/5 and 50/50 read/write
+mixes (writes are half inserts, half removes).
+Outputs CSV to the file given as the first argument (concurrent.csv by
+default).
+
+                        , 1, 2, 4, 8, 16, 32
+    CONCURRENT 100/0    , 5.91, ...
+    LOCKED 100/0        , ...
+    CONCURRENT 95/5     , ...
+    ...
+    STRESS ERRORS       , 0
+
+Throughput values are millions of operations per second, for all threads.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include "BinTree.hh"
+#include "ConcurrentBinTree.hh"
+using namespace std;
+
+const uint32_t treeSize = 100000; ///<The number of items to start with
+const uint32_t opsPerThread = 200000; ///<The operations each thread runs
+const uint32_t maxThreads = 32;
+const uint32_t stressWriters = 2;
+const uint32_t stressReaders = 6;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+//the same operations on each kind of shared tree
+struct LockedTree {
+    BinTree<uint64_t> tree;
+    mutex lock;
+    LockedTree() : tree(RED_BLACK) {}
+};
+bool has(ConcurrentBinTree<uint64_t>& tree, uint64_t k) {
+    return tree.contains(k);
+}
+void add(ConcurrentBinTree<uint64_t>& tree, uint64_t k) { tree.insert(k); }
+void drop(ConcurrentBinTree<uint64_t>& tree, uint64_t k) { tree.remove(k); }
+bool has(LockedTree& shared, uint64_t k) {
+    lock_guard<mutex> guard(shared.lock);
+    return shared.tree.search(k).first;
+}
+void add(LockedTree& shared, uint64_t k) {
+    lock_guard<mutex> guard(shared.lock);
+    shared.tree.insert(k);
+}
+void drop(LockedTree& shared, uint64_t k) {
+    lock_guard<mutex> guard(shared.lock);
+    shared.tree.remove(k);
+}
+
+/**@brief runs the same mix of operations on several threads at once
+   @param tree the shared tree, already filled
+   @param threads the number of threads to run
+   @param readPercent the percentage of operations that are searches
+   @return millions of operations per second
+*/
+template<class Tree>
+double throughput(Tree& tree, uint32_t threads, uint32_t readPercent) {
+    vector<thread> workers;
+    atomic<uint64_t> found(0);
+
+    auto start = chrono::steady_clock::now();
+    for (uint32_t t = 0; t < threads; t++)
+    {
+        workers.emplace_back([&tree, &found, t, readPercent]() {
+            mt19937_64 rng(t + 1);
+            uint64_t hits = 0;
+            for (uint32_t i = 0; i < opsPerThread; i++)
+            {
+                uint64_t k = rng() % (2 * treeSize);
+                uint32_t op = rng() % 100;
+                if (op < readPercent)
+                    hits += has(tree, k);
+                else if ((op - readPercent) % 2 == 0)
+                    add(tree, k);
+                else
+                    drop(tree, k);
+            }
+            found += hits;
+        });
+    }
+    for (thread& w : workers)
+        w.join();
+    return threads * opsPerThread / since(start) / 1e6;
+}
+
+uint64_t lastItem; ///<used by checkOrder()
+uint32_t visited; ///<used by checkOrder()
+uint32_t orderErrors; ///<used by checkOrder()
+
+///@brief counts the items and checks that they arrive in order
+void checkOrder(const uint64_t& item, uint32_t level) {
+    if (visited > 0 && !(lastItem < item))
+        orderErrors++;
+    lastItem = item;
+    visited++;
+}
+
+/**@brief changes the tree from some threads while others search it
+   @return the number of errors found
+*/
+uint32_t stress() {
+    ConcurrentBinTree<uint64_t> tree;
+    for (uint64_t k = 0; k < treeSize; k++)
+        tree.insert(2 * k);
+
+    atomic<uint32_t> errors(0);
+    atomic<bool> done(false);
+    vector<thread> writers, readers;
+    for (uint32_t t = 0; t < stressWriters; t++)
+    {
+        writers.emplace_back([&tree, t]() {
+            mt19937_64 rng(100 + t);
+            for (uint32_t i = 0; i < opsPerThread; i++)
+            {
+                uint64_t k = 2 * (rng() % treeSize) + 1;
+                if (rng() % 2)
+                    tree.insert(k);
+                else
+                    tree.remove(k);
+            }
+        });
+    }
+    for (uint32_t t = 0; t < stressReaders; t++)
+    {
+        readers.emplace_back([&tree, &errors, &done, t]() {
+            mt19937_64 rng(200 + t);
+            while (!done)
+            {
+                uint64_t k = 2 * (rng() % treeSize);
+                if (!tree.contains(k))
+                    errors++;
+            }
+        });
+    }
+    for (thread& w : writers)
+        w.join();
+    done = true;
+    for (thread& r : readers)
+        r.join();
+
+    visited = 0;
+    orderErrors = 0;
+    tree.traverse(IN_ORDER, checkOrder);
+    if (visited != tree.count())
+        errors++;
+    errors += orderErrors;
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "concurrent.csv" : argv[1]);
+    const uint32_t readPercents[] = {100, 95, 50};
+    const string mixStr[] = {"100/0", "95/5", "50/50"};
+
+    out << ",";
+    for (uint32_t threads = 1; threads <= maxThreads; threads *= 2)
+        out << threads << ",";
+
+    for (int m = 0; m < 3; m++)
+    {
+        string concurrentRow, lockedRow;
+        for (uint32_t threads = 1; threads <= maxThreads; threads *= 2)
+        {
+            ConcurrentBinTree<uint64_t> concurrent;
+            LockedTree locked;
+            for (uint64_t k = 0; k < treeSize; k++)
+            {
+                concurrent.insert(2 * k);
+                locked.tree.insert(2 * k);
+            }
+            concurrentRow += to_string(throughput(concurrent, threads,
+                                                  readPercents[m])) + ",";
+            lockedRow += to_string(throughput(locked, threads,
+                                              readPercents[m])) + ",";
+        }
+        out << endl << "CONCURRENT " << mixStr[m] << "," << concurrentRow
+            << endl << "LOCKED " << mixStr[m] << "," << lockedRow;
+    }
+
+    uint32_t errors = stress();
+    if (errors != 0)
+        cerr << "ConcurrentBinTree stress test: " << errors << " errors"
+             << endl;
+    out << endl << "STRESS ERRORS," << errors << endl;
+}
@@ -0,0 +1,99 @@
+/**@file depth.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Measures how tall a BinTree gets, and how long it takes to build, for each
+TreeBalance and insertion order. Outputs CSV to the file given as the first
+argument (depth.csv in the working directory by default).
+
+                      , 1000, 10000, 100000, 1000000
+    LG(N)             , 10,   14,    17,     20
+    RED_BLACK SORTED  , 17,   24,    31,     37
+    ...
+    RED_BLACK SORTED S, 0.0001, ...
+
+Rows without an S give the height of the tree, rows ending in S give the time
+(in seconds) it took to insert every value. UNBALANCED trees are only built up
+to unbalancedMax values, since sorted data makes them take O(n^2) time.
+*/
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include "BinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t unbalancedMax = 10000; ///<The biggest UNBALANCED tree to build
+
+enum InsertOrder {SORTED, REVERSE, RANDOM};
+
+/**@brief builds a tree and measures it
+   @param balance the balancing scheme to use
+   @param order the order to insert 0...size - 1 in
+   @param size the number of values to insert
+   @param seconds set to the time the inserts took
+   @return the height of the tree
+*/
+uint32_t buildTree(TreeBalance balance, InsertOrder order, uint32_t size,
+                   double& seconds) {
+    vector<uint32_t> keys(size);
+    for (uint32_t i = 0; i < size; i++)
+        keys[i] = (order == REVERSE) ? size - 1 - i : i;
+    if (order == RANDOM)
+        shuffle(keys.begin(), keys.end(), mt19937(42));
+
+    BinTree<uint32_t> tree(balance);
+    auto start = chrono::steady_clock::now();
+    for (uint32_t k : keys)
+        tree.insert(k);
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start)
+              .count();
+    return tree.height();
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "depth.csv" : argv[1]);
+    const string balanceStr[] = {"UNBALANCED", "RED_BLACK"};
+    const string orderStr[] = {"SORTED", "REVERSE", "RANDOM"};
+
+    out << ",";
+    for (uint32_t size = 1000; size <= maxSize; size *= 10)
+        out << size << ",";
+    out << endl << "LG(N),";
+    for (uint32_t size = 1000; size <= maxSize; size *= 10)
+        out << ceil(log2(size)) << ",";
+
+    for (int b = 0; b < 2; b++)
+    {
+        TreeBalance balance = static_cast<TreeBalance>(b);
+        for (int o = 0; o < 3; o++)
+        {
+            string heights, times;
+            for (uint32_t size = 1000; size <= maxSize; size *= 10)
+            {
+                if (balance == UNBALANCED && size > unbalancedMax)
+                {
+                    heights += ",";
+                    times += ",";
+                    continue;
+                }
+                double seconds;
+                heights += to_string(buildTree(balance,
+                                               static_cast<InsertOrder>(o),
+                                               size, seconds)) + ",";
+                times += to_string(seconds) + ",";
+            }
+            out << endl << balanceStr[b] << " " << orderStr[o] << ","
+                << heights;
+            out << endl << balanceStr[b] << " " << orderStr[o] << " S,"
+                << times;
+        }
+        cout << "Finished " << balanceStr[b] << " trees." << endl;
+    }
+    out << endl;
+}
@@ -0,0 +1,95 @@
+/**@file frozen.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Compares searching a BinTree (RED_BLACK) with searching the FrozenBinTree
+that freeze() makes from it, and with std::lower_bound on a sorted array
+(the same data without the Eytzinger layout). Every structure holds the
+even numbers below 2 * size and is searched for random keys, half of which
+are missing.
+Outputs CSV to the file given as the first argument (frozen.csv by default).
+
+                  , 10000, 100000, 1000000
+    BINTREE SEARCH, 0.0004, ...
+    FROZEN SEARCH , ...
+    SORTED SEARCH , ...
+    FREEZE        , ...
+    BINTREE BYTES , 400000, ...
+    FROZEN BYTES  , ...
+
+SEARCH rows are the time in seconds for lookupCount searches, FREEZE is the
+time to make the snapshot, and BYTES rows are the memory used by the items.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "BinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t lookupCount = 1000000; ///<The number of searches to time
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "frozen.csv" : argv[1]);
+    string treeRow, frozenRow, sortedRow, freezeRow, treeBytes, frozenBytes;
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        vector<uint64_t> sorted(size);
+        for (uint32_t i = 0; i < size; i++)
+            sorted[i] = 2 * i;
+        BinTree<uint64_t> tree(RED_BLACK);
+        tree.build(sorted.begin(), sorted.end());
+
+        auto start = chrono::steady_clock::now();
+        FrozenBinTree<uint64_t> frozen = tree.freeze();
+        freezeRow += to_string(since(start)) + ",";
+
+        vector<uint64_t> keys(lookupCount);
+        mt19937_64 rng(42);
+        for (uint64_t& k : keys)
+            k = rng() % (2 * size);
+
+        uint64_t found[3] = {0, 0, 0};
+        start = chrono::steady_clock::now();
+        for (uint64_t k : keys)
+            found[0] += tree.search(k).first;
+        treeRow += to_string(since(start)) + ",";
+
+        start = chrono::steady_clock::now();
+        for (uint64_t k : keys)
+            found[1] += frozen.contains(k);
+        frozenRow += to_string(since(start)) + ",";
+
+        start = chrono::steady_clock::now();
+        for (uint64_t k : keys)
+            found[2] += binary_search(sorted.begin(), sorted.end(), k);
+        sortedRow += to_string(since(start)) + ",";
+
+        if (found[0] != found[1] || found[1] != found[2])
+            cerr << "The searches disagree at size " << size << endl;
+
+        treeBytes += to_string(size * sizeof(Node<uint64_t>)) + ",";
+        frozenBytes += to_string(frozen.memory()) + ",";
+    }
+
+    out << endl << "BINTREE SEARCH," << treeRow
+        << endl << "FROZEN SEARCH," << frozenRow
+        << endl << "SORTED SEARCH," << sortedRow
+        << endl << "FREEZE," << freezeRow
+        << endl << "BINTREE BYTES," << treeBytes
+        << endl << "FROZEN BYTES," << frozenBytes << endl;
+}
@@ -0,0 +1,207 @@
+/**@file orderstats.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Checks select(), rank() and countInRange() against a sorted std::vector, and
+times them, for each TreeBalance. Each tree goes through random inserts,
+removes and searches (which rotate a SPLAY tree), a split() and a unionWith()
+putting it back together, and a subtract(). Every subtree size is checked
+after each step: the walk down from the root must count the same items as
+the reference, at every position. Outputs CSV to the file given as the first
+argument (orderstats.csv by default).
+
+                             , 1000, 10000, 100000
+    UNBALANCED SELECT        , 0.0085, ...
+    UNBALANCED RANK          , ...
+    UNBALANCED COUNT IN RANGE, ...
+    RED_BLACK SELECT         , ...
+    ...
+
+Every value is the time in seconds for queryCount calls on the finished
+tree. Exits with 1 if any call disagrees with the reference.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "BinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 100000; ///<The biggest tree to build
+const uint32_t queryCount = 100000; ///<The number of calls to time
+const int balanceCount = 4;
+const string balanceStr[] = {"UNBALANCED", "RED_BLACK", "SPLAY",
+                             "SEMI_SPLAY"};
+
+enum Query {SELECT, RANK, COUNT_IN_RANGE};
+const int queryKinds = 3;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+/**@brief compares the order statistics of a tree with a reference
+   @param tree the tree to check
+   @param ref the items that should be in the tree
+   @param step what was just done to the tree, for the error message
+   @return the number of mismatches found
+*/
+uint32_t check(const BinTree<uint32_t>& tree, const set<uint32_t>& ref,
+               const string& step) {
+    const vector<uint32_t> sorted(ref.begin(), ref.end());
+    uint32_t errors = 0;
+    auto fail = [&](const string& what) {
+        if (errors++ == 0)
+            cerr << balanceStr[tree.getBalance()] << " after " << step
+                 << ": " << what << endl;
+    };
+
+    if (tree.count() != sorted.size())
+        fail("count() is " + to_string(tree.count()));
+    if (tree.select(sorted.size()) != tree.end())
+        fail("select(count()) is not end()");
+    for (uint32_t k = 0; k < sorted.size(); k++)
+    {
+        BinTree<uint32_t>::iterator i = tree.select(k);
+        if (i == tree.end() || *i != sorted[k])
+            fail("select(" + to_string(k) + ") is wrong");
+        if (tree.rank(sorted[k]) != k)
+            fail("rank(" + to_string(sorted[k]) + ") is wrong");
+    }
+
+    //keys around and between the items, in and out of the tree
+    mt19937 rng(sorted.size());
+    const uint32_t top = sorted.empty() ? 1 : sorted.back() + 2;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        uint32_t low = rng() % top, high = rng() % top;
+        size_t below = lower_bound(sorted.begin(), sorted.end(), low) -
+                       sorted.begin();
+        if (tree.rank(low) != below)
+            fail("rank(" + to_string(low) + ") is wrong");
+        size_t inRange = (high < low) ? 0 :
+            upper_bound(sorted.begin(), sorted.end(), high) -
+            sorted.begin() - below;
+        if (tree.countInRange(low, high) != inRange)
+            fail("countInRange(" + to_string(low) + ", " + to_string(high) +
+                 ") is wrong");
+    }
+    return errors;
+}
+
+/**@brief churns, splits and rebuilds one tree, checking it after each step
+   @param balance the balancing scheme to use
+   @param size roughly the number of items the tree holds
+   @param rows one row per Query, each gets a value appended
+   @return the number of mismatches found
+*/
+uint32_t run(TreeBalance balance, uint32_t size, string rows[]) {
+    BinTree<uint32_t> tree(balance);
+    set<uint32_t> ref;
+    mt19937 rng(42);
+    const uint32_t range = 2 * size; //so removes and searches hit half the time
+    uint32_t errors = 0;
+
+    //inserts win half the time over removes, so the tree grows to about size
+    for (uint32_t round = 0; round < 4; round++)
+    {
+        for (uint32_t i = 0; i < size; i++)
+        {
+            uint32_t k = rng() % range;
+            switch (rng() % 4)
+            {
+            case 0:
+            case 1:
+                tree.insert(k);
+                ref.insert(k);
+                break;
+            case 2:
+                tree.remove(k);
+                ref.erase(k);
+                break;
+            default:
+                tree.search(k);
+            }
+        }
+        errors += check(tree, ref, "churn round " + to_string(round));
+    }
+
+    const uint32_t cut = rng() % range;
+    BinTree<uint32_t> upper = tree.split(cut);
+    set<uint32_t> refUpper(ref.lower_bound(cut), ref.end());
+    ref.erase(ref.lower_bound(cut), ref.end());
+    errors += check(tree, ref, "split");
+    errors += check(upper, refUpper, "split (the items >= key)");
+
+    tree.unionWith(upper);
+    ref.insert(refUpper.begin(), refUpper.end());
+    errors += check(tree, ref, "unionWith");
+
+    BinTree<uint32_t> drop(balance);
+    for (uint32_t i = 0; i < size / 4; i++)
+    {
+        uint32_t k = rng() % range;
+        drop.insert(k);
+        ref.erase(k);
+    }
+    tree.subtract(drop);
+    errors += check(tree, ref, "subtract");
+
+    //time the calls on the finished tree
+    vector<uint32_t> keys(queryCount);
+    for (uint32_t& k : keys)
+        k = rng() % range;
+    uint64_t sum = 0;
+    auto start = chrono::steady_clock::now();
+    for (uint32_t k : keys)
+    {
+        BinTree<uint32_t>::iterator i = tree.select(k % tree.count());
+        sum += *i;
+    }
+    rows[SELECT] += to_string(since(start)) + ",";
+    start = chrono::steady_clock::now();
+    for (uint32_t k : keys)
+        sum += tree.rank(k);
+    rows[RANK] += to_string(since(start)) + ",";
+    start = chrono::steady_clock::now();
+    for (uint32_t k : keys)
+        sum += tree.countInRange(k, k + size / 10);
+    rows[COUNT_IN_RANGE] += to_string(since(start)) + ",";
+    if (sum == 0) //keeps the calls from being optimized away
+        cerr << "Every call returned 0 at size " << size << endl;
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "orderstats.csv" : argv[1]);
+    const string queryStr[] = {"SELECT", "RANK", "COUNT IN RANGE"};
+    vector<string> rows(balanceCount * queryKinds);
+    uint32_t errors = 0;
+
+    out << ",";
+    for (uint32_t size = 1000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+        for (int b = 0; b < balanceCount; b++)
+            errors += run(static_cast<TreeBalance>(b), size,
+                          &rows[b * queryKinds]);
+        cout << "Finished size " << size << "." << endl;
+    }
+
+    for (int b = 0; b < balanceCount; b++)
+    {
+        for (int q = 0; q < queryKinds; q++)
+            out << endl << balanceStr[b] << " " << queryStr[q] << ","
+                << rows[b * queryKinds + q];
+    }
+    out << endl;
+    if (errors > 0)
+        cerr << errors << " mismatches with the sorted reference" << endl;
+    return errors > 0;
+}
@@ -0,0 +1,130 @@
+/**@file persistent.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Compares taking point-in-time copies of a changing tree: copying a BinTree
+(RED_BLACK) against a PersistentBinTree snapshot, and what each update costs
+in both. The PersistentBinTree takes a snapshot before every
+snapshotInterval updates and keeps the last snapshotsKept of them, so its
+updates pay for copying their paths.
+Outputs CSV to the file given as the first argument (persistent.csv by
+default).
+
+                       , 10000, 100000, 1000000
+    BINTREE COPY       , 214.0, ...
+    PERSISTENT SNAPSHOT, ...
+    BINTREE UPDATE     , ...
+    PERSISTENT UPDATE  , ...
+
+COPY and SNAPSHOT rows are microseconds per copy, UPDATE rows are the seconds
+for updateCount updates (half inserts, half removes of random keys),
+including the copies taken along the way.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "BinTree.hh"
+#include "PersistentBinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t updateCount = 100000; ///<The number of updates to time
+const uint32_t snapshotInterval = 1000; ///<Updates between snapshots
+const uint32_t snapshotsKept = 4; ///<Snapshots alive at once
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "persistent.csv" : argv[1]);
+    string copyRow, snapshotRow, treeUpdateRow, persistentUpdateRow;
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        vector<uint64_t> keys(size);
+        for (uint32_t i = 0; i < size; i++)
+            keys[i] = 2 * i;
+        shuffle(keys.begin(), keys.end(), mt19937(42));
+
+        BinTree<uint64_t> tree(RED_BLACK);
+        PersistentBinTree<uint64_t> persistent;
+        for (uint64_t k : keys)
+        {
+            tree.insert(k);
+            persistent.insert(k);
+        }
+
+        //copies: a few BinTree copies, many snapshots
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < 10; i++)
+        {
+            BinTree<uint64_t> copy(tree);
+        }
+        copyRow += to_string(since(start) / 10 * 1e6) + ",";
+
+        start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < updateCount; i++)
+        {
+            PersistentBinTree<uint64_t> snap = persistent.snapshot();
+        }
+        snapshotRow += to_string(since(start) / updateCount * 1e6) + ",";
+
+        //updates, the BinTree is copied as often as the snapshots are taken
+        mt19937_64 rng(7);
+        vector<BinTree<uint64_t> > copies;
+        start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < updateCount; i++)
+        {
+            if (i % snapshotInterval == 0)
+            {
+                if (copies.size() == snapshotsKept)
+                    copies.erase(copies.begin());
+                copies.push_back(tree);
+            }
+            uint64_t k = rng() % (2 * size);
+            if (i % 2)
+                tree.insert(k);
+            else
+                tree.remove(k);
+        }
+        treeUpdateRow += to_string(since(start)) + ",";
+        copies.clear();
+
+        rng.seed(7);
+        vector<PersistentBinTree<uint64_t> > snaps;
+        start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < updateCount; i++)
+        {
+            if (i % snapshotInterval == 0)
+            {
+                if (snaps.size() == snapshotsKept)
+                    snaps.erase(snaps.begin());
+                snaps.push_back(persistent.snapshot());
+            }
+            uint64_t k = rng() % (2 * size);
+            if (i % 2)
+                persistent.insert(k);
+            else
+                persistent.remove(k);
+        }
+        persistentUpdateRow += to_string(since(start)) + ",";
+
+        if (tree.count() != persistent.count())
+            cerr << "The trees disagree at size " << size << endl;
+    }
+
+    out << endl << "BINTREE COPY," << copyRow
+        << endl << "PERSISTENT SNAPSHOT," << snapshotRow
+        << endl << "BINTREE UPDATE," << treeUpdateRow
+        << endl << "PERSISTENT UPDATE," << persistentUpdateRow << endl;
+}
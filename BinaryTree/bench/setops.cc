@@ -0,0 +1,125 @@
+/**@file setops.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Combines a delta tree of each size with a RED_BLACK base tree of baseSize
+random keys, the way a day's changes are folded into a big table. Half of
+each delta's keys are already in the base.
+- UNION: base.unionWith(delta), split and join
+- UNION PARALLEL: the same, on parallelThreads threads
+- INSERT: base.insert() for every item of delta
+- REBUILD: base + delta, which merges both and rebuilds (O(n + m))
+- INTERSECT: base.intersectWith(delta)
+- SUBTRACT: base.subtract(delta)
+Outputs CSV to the file given as the first argument (setops.csv by
+default).
+
+                    , 10, 100, ..., 1000000
+    UNION           , 0.000059, ...
+    UNION PARALLEL  , ...
+    INSERT          , ...
+    REBUILD         , ...
+    INTERSECT       , ...
+    SUBTRACT        , ...
+
+Every value is the time in seconds for one operation. Copying the base
+before each operation is not timed.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "BinTree.hh"
+using namespace std;
+
+const uint32_t baseSize = 1000000; ///<The number of keys in the base tree
+const uint32_t maxDelta = 1000000; ///<The biggest delta tree
+const unsigned parallelThreads = 4; ///<Threads for UNION PARALLEL
+
+enum SetOp {UNION, UNION_PARALLEL, INSERT, REBUILD, INTERSECT, SUBTRACT};
+const int opCount = 6;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+/**@brief times one operation on a copy of base
+   @return the number of items in the result, to check the ops agree
+*/
+uint32_t timeOp(SetOp op, const BinTree<uint64_t>& base,
+                const BinTree<uint64_t>& delta, double& seconds) {
+    BinTree<uint64_t> tree(base);
+    auto start = chrono::steady_clock::now();
+    switch (op)
+    {
+    case UNION:
+        tree.unionWith(delta);
+        break;
+    case UNION_PARALLEL:
+        tree.unionWith(delta, parallelThreads);
+        break;
+    case INSERT:
+        for (uint64_t k : delta)
+            tree.insert(k);
+        break;
+    case REBUILD:
+        tree = base + delta;
+        break;
+    case INTERSECT:
+        tree.intersectWith(delta);
+        break;
+    case SUBTRACT:
+        tree.subtract(delta);
+        break;
+    }
+    seconds = since(start);
+    return tree.count();
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "setops.csv" : argv[1]);
+    const string opStr[] = {"UNION", "UNION PARALLEL", "INSERT", "REBUILD",
+                            "INTERSECT", "SUBTRACT"};
+    vector<string> rows(opCount);
+
+    //even keys are in the base, odd keys never are
+    vector<uint64_t> keys(baseSize);
+    for (uint32_t i = 0; i < baseSize; i++)
+        keys[i] = 2 * i;
+    shuffle(keys.begin(), keys.end(), mt19937(42));
+    BinTree<uint64_t> base(RED_BLACK);
+    for (uint64_t k : keys)
+        base.insert(k);
+
+    mt19937_64 rng(7);
+    out << ",";
+    for (uint32_t size = 10; size <= maxDelta; size *= 10)
+    {
+        out << size << ",";
+        BinTree<uint64_t> delta(RED_BLACK);
+        for (uint32_t i = 0; i < size; i++)
+            delta.insert(2 * (rng() % baseSize) + i % 2);
+
+        uint32_t unionCount = 0;
+        for (int op = 0; op < opCount; op++)
+        {
+            double seconds;
+            uint32_t count = timeOp(static_cast<SetOp>(op), base, delta,
+                                    seconds);
+            rows[op] += to_string(seconds) + ",";
+            if (op == UNION)
+                unionCount = count;
+            else if (op < INTERSECT && count != unionCount)
+                cerr << opStr[op] << " disagrees at size " << size << endl;
+        }
+    }
+
+    for (int op = 0; op < opCount; op++)
+        out << endl << opStr[op] << "," << rows[op];
+    out << endl;
+}
@@ -0,0 +1,150 @@
+/**@file splay.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Replays skewed and sequential search traces against each TreeBalance, to
+show when a SPLAY tree pays off. Every tree holds the same keys, inserted in
+the same random order, then searches accessCount keys from one trace:
+- ZIPF: key ranks drawn from a Zipf distribution with exponent zipfSkew, so
+  the hottest 1% of the keys get about 90% of the searches (at 1000000 keys).
+  Ranks are shuffled onto the keys, so hot keys are not next to each other.
+- SEQUENTIAL: every key in ascending order, over and over
+Outputs CSV to the file given as the first argument (splay.csv by default).
+
+                           , 10000, 100000, 1000000
+    UNBALANCED ZIPF        , 0.0555, ...
+    UNBALANCED ZIPF CMP    , 16.17, ...
+    RED_BLACK ZIPF         , ...
+    ...
+    SEMI_SPLAY SEQUENTIAL CMP, ...
+
+Rows without CMP give the time in seconds for the whole trace. CMP rows give
+the average number of nodes each search was compared against (the level
+search() found the key on, plus 1), which includes the time a SPLAY tree
+spends getting into shape at the start of the trace.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include "BinTree.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t accessCount = 1000000; ///<The number of searches per trace
+const double zipfSkew = 1.2; ///<The Zipf exponent, higher is more skewed
+
+enum Trace {ZIPF, SEQUENTIAL};
+const int traceCount = 2;
+const int balanceCount = 4;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+/**@brief makes a trace of keys to search for
+   @param trace the kind of trace
+   @param size the keys are 0 to size - 1
+   @return accessCount keys
+*/
+vector<uint32_t> makeTrace(Trace trace, uint32_t size) {
+    vector<uint32_t> keys(accessCount);
+    if (trace == SEQUENTIAL)
+    {
+        for (uint32_t i = 0; i < accessCount; i++)
+            keys[i] = i % size;
+        return keys;
+    }
+
+    //cdf[r] is the chance of drawing a rank <= r
+    vector<double> cdf(size);
+    double total = 0;
+    for (uint32_t r = 0; r < size; r++)
+    {
+        total += pow(r + 1, -zipfSkew);
+        cdf[r] = total;
+    }
+    vector<uint32_t> keyOfRank(size);
+    for (uint32_t r = 0; r < size; r++)
+        keyOfRank[r] = r;
+    shuffle(keyOfRank.begin(), keyOfRank.end(), mt19937(3));
+
+    mt19937_64 rng(7);
+    uniform_real_distribution<double> draw(0, total);
+    for (uint32_t& k : keys)
+    {
+        size_t rank = lower_bound(cdf.begin(), cdf.end(), draw(rng)) -
+                      cdf.begin();
+        k = keyOfRank[min<size_t>(rank, size - 1)];
+    }
+    return keys;
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "splay.csv" : argv[1]);
+    const string balanceStr[] = {"UNBALANCED", "RED_BLACK", "SPLAY",
+                                 "SEMI_SPLAY"};
+    const string traceStr[] = {"ZIPF", "SEQUENTIAL"};
+    //rows[balance][trace][0] is seconds, [1] is comparisons
+    vector<string> rows(balanceCount * traceCount * 2);
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        vector<uint32_t> order(size);
+        for (uint32_t i = 0; i < size; i++)
+            order[i] = i;
+        shuffle(order.begin(), order.end(), mt19937(42));
+        vector<uint32_t> traces[traceCount] = {makeTrace(ZIPF, size),
+                                               makeTrace(SEQUENTIAL, size)};
+
+        for (int b = 0; b < balanceCount; b++)
+        {
+            for (int t = 0; t < traceCount; t++)
+            {
+                BinTree<uint32_t> tree(static_cast<TreeBalance>(b));
+                for (uint32_t k : order)
+                    tree.insert(k);
+
+                uint32_t found = 0;
+                uint64_t compared = 0;
+                auto start = chrono::steady_clock::now();
+                for (uint32_t k : traces[t])
+                {
+                    pair<bool, uint32_t> result = tree.search(k);
+                    found += result.first;
+                    compared += result.second + 1;
+                }
+                double seconds = since(start);
+                if (found != accessCount)
+                    cerr << "Keys went missing at size " << size << endl;
+
+                int row = (b * traceCount + t) * 2;
+                rows[row] += to_string(seconds) + ",";
+                rows[row + 1] += to_string(static_cast<double>(compared) /
+                                           accessCount) + ",";
+            }
+        }
+        cout << "Finished size " << size << "." << endl;
+    }
+
+    for (int b = 0; b < balanceCount; b++)
+    {
+        for (int t = 0; t < traceCount; t++)
+        {
+            int row = (b * traceCount + t) * 2;
+            string name = balanceStr[b] + " " + traceStr[t];
+            out << endl << name << "," << rows[row]
+                << endl << name << " CMP," << rows[row + 1];
+        }
+    }
+    out << endl;
+}
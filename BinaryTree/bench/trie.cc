@@ -0,0 +1,118 @@
+/**@file trie.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Compares a RadixTrie with a BinTree<string> (RED_BLACK) holding the same
+path-like keys, "/api/v1/users/<id>/profile", which share a long prefix the
+way real names and URLs do. Each structure inserts size keys in random
+order, searches for lookupCount random keys (half of them missing), then
+runs prefixCount prefix queries for "/api/v1/users/<n>", with n drawn so
+that a query matches 100 to 200 keys on average. BinTree answers those with
+lower_bound() and walks until the prefix no longer matches.
+Outputs CSV to the file given as the first argument (trie.csv by default).
+
+                   , 10000, 100000, 1000000
+    BINTREE INSERT , 0.0041, ...
+    TRIE INSERT    , ...
+    BINTREE SEARCH , ...
+    TRIE SEARCH    , ...
+    BINTREE PREFIX , ...
+    TRIE PREFIX    , ...
+
+Every value is the time in seconds for the whole phase.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "BinTree.hh"
+#include "RadixTrie.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest tree to build
+const uint32_t lookupCount = 1000000; ///<The number of searches to time
+const uint32_t prefixCount = 10000; ///<The number of prefix queries to time
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+///@brief makes the key for user id
+string makeKey(uint64_t id) {
+    return "/api/v1/users/" + to_string(id) + "/profile";
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "trie.csv" : argv[1]);
+    string rows[6];
+
+    out << ",";
+    for (uint32_t size = 10000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        //even ids are in the trees, odd ids never are
+        vector<string> keys(size);
+        for (uint32_t i = 0; i < size; i++)
+            keys[i] = makeKey(2 * i);
+        shuffle(keys.begin(), keys.end(), mt19937(42));
+        mt19937_64 rng(7);
+        vector<string> lookups(lookupCount);
+        for (string& k : lookups)
+            k = makeKey(rng() % (2 * size));
+        //every id that starts with the digits of n matches
+        vector<string> prefixes(prefixCount);
+        for (string& p : prefixes)
+            p = "/api/v1/users/" + to_string(rng() % (size / 50) + 1);
+
+        BinTree<string> tree(RED_BLACK);
+        RadixTrie trie;
+        uint64_t found[2] = {0, 0};
+
+        auto start = chrono::steady_clock::now();
+        for (const string& k : keys)
+            tree.insert(k);
+        rows[0] += to_string(since(start)) + ",";
+        start = chrono::steady_clock::now();
+        for (const string& k : keys)
+            trie.insert(k);
+        rows[1] += to_string(since(start)) + ",";
+
+        start = chrono::steady_clock::now();
+        for (const string& k : lookups)
+            found[0] += tree.search(k).first;
+        rows[2] += to_string(since(start)) + ",";
+        start = chrono::steady_clock::now();
+        for (const string& k : lookups)
+            found[1] += trie.search(k).first;
+        rows[3] += to_string(since(start)) + ",";
+
+        start = chrono::steady_clock::now();
+        for (const string& p : prefixes)
+        {
+            for (auto i = tree.lower_bound(p);
+                 i != tree.end() && i->compare(0, p.size(), p) == 0; ++i)
+                found[0]++;
+        }
+        rows[4] += to_string(since(start)) + ",";
+        start = chrono::steady_clock::now();
+        for (const string& p : prefixes)
+            trie.prefixScan(p, [&found](const string&) { found[1]++; });
+        rows[5] += to_string(since(start)) + ",";
+
+        if (found[0] != found[1] || trie.count() != tree.count())
+            cerr << "The trees disagree at size " << size << endl;
+        cout << "Finished size " << size << "." << endl;
+    }
+
+    const string rowStr[] = {"BINTREE INSERT", "TRIE INSERT", "BINTREE SEARCH",
+                             "TRIE SEARCH", "BINTREE PREFIX", "TRIE PREFIX"};
+    for (int r = 0; r < 6; r++)
+        out << endl << rowStr[r] << "," << rows[r];
+    out << endl;
+}
@@ -0,0 +1,485 @@
+/**@file workload.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Drives every tree in src/ and the standard containers through the same
+workloads, to gate changes on. Each run builds one container with size keys
+(LOAD), runs ops mixed operations on it (MIX), copies it (COPY) and walks it
+in order (SCAN), the last two rounds times each.
+
+Containers: BINTREE (RED_BLACK), SPLAY, COMPACT (CompactBinTree), BTREE,
+RADIX (RadixTrie, STRING keys only), STD_SET, BINTREEMAP and STD_MAP (the
+maps hold a uint64_t per key).
+Keys: INT64, or STRING ("user:" and a number, so every comparison has to
+get past a common prefix). Every container sees the same keys, in the same
+order.
+
+Workloads (the MIX phase):
+- read-uniform: lookups of random keys, half of them missing
+- read-zipf: lookups of keys drawn from a Zipf distribution (exponent 1),
+  90% hits
+- read-miss: lookups of random keys, 80% missing
+- sorted-load: LOAD inserts the keys in ascending order, then as
+  read-uniform
+- churn: 50% lookups, 25% inserts of new keys, 25% removes (half of them
+  of keys that are there)
+
+Usage: workload [file.csv] [name=value ...]
+- size=N, ops=N, rounds=N: the keys loaded, MIX operations and COPY/SCAN
+  rounds (100000, 1000000 and 5 by default)
+- key=, container=, workload=: run only that one
+- order=random|sorted, reads=F, inserts=F, removes=F, hit=F, zipf=F: change
+  that part of every workload (F is a fraction, or the Zipf exponent, 0 for
+  uniform)
+
+Outputs CSV to file.csv (workload.csv by default), one row per phase:
+
+    container,key,workload,phase,ops,ops/sec,p50 ns,p99 ns,p99.9 ns,max ns,
+        peak RSS KB
+    BINTREE,INT64,read-uniform,LOAD,100000,3.86522e+06,226,1768,2212,...
+    BINTREE,INT64,read-uniform,MIX,1000000,2.8361e+06,329,713,2174,...
+
+Latencies are per operation, except for COPY and SCAN, where they are per
+round (and ops counts every item copied or visited). Each run happens in its
+own process, so peak RSS is that run's high water mark: the container at its
+biggest, plus the key and operation lists (the same size for every
+container).
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <cstdlib>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "BinTree.hh"
+#include "BinTreeMap.hh"
+#include "CompactBinTree.hh"
+#include "BTree.hh"
+#include "RadixTrie.hh"
+using namespace std;
+
+enum KeyOrder {RANDOM, SORTED};
+enum OpKind {READ, INSERT, REMOVE};
+
+///@brief What the MIX phase does, and the order LOAD inserts in
+struct Workload {
+    string name;
+    KeyOrder order;
+    double reads, inserts, removes; ///< the share of each kind of operation
+    double hit;  ///< the share of reads and removes that find their key
+    double zipf; ///< the Zipf exponent that keys are drawn with, 0 for uniform
+};
+
+vector<Workload> workloads = {
+    {"read-uniform", RANDOM, 1, 0, 0, 0.5, 0},
+    {"read-zipf", RANDOM, 1, 0, 0, 0.9, 1},
+    {"read-miss", RANDOM, 1, 0, 0, 0.2, 0},
+    {"sorted-load", SORTED, 1, 0, 0, 0.5, 0},
+    {"churn", RANDOM, 0.5, 0.25, 0.25, 0.5, 0}
+};
+
+struct Settings {
+    uint32_t size = 100000;
+    uint32_t ops = 1000000;
+    uint32_t rounds = 5;
+    string key, container, workload; ///< empty to run them all
+    string file = "workload.csv";
+};
+
+///@brief The timings of one phase
+struct Phase {
+    string name;
+    uint64_t ops;
+    double seconds;
+    vector<uint64_t> ns; ///< the latency of each operation (or round)
+};
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+//the same operations on each kind of container
+template<class Tree, class Key>
+bool has(Tree& tree, const Key& k) {
+    return tree.search(k).first;
+}
+template<class Key>
+bool has(set<Key>& tree, const Key& k) {
+    return tree.count(k);
+}
+template<class Key>
+bool has(BinTreeMap<Key, uint64_t>& tree, const Key& k) {
+    return tree.contains(k);
+}
+template<class Key>
+bool has(map<Key, uint64_t>& tree, const Key& k) {
+    return tree.count(k);
+}
+template<class Tree, class Key>
+void add(Tree& tree, const Key& k) {
+    tree.insert(k);
+}
+template<class Key>
+void add(BinTreeMap<Key, uint64_t>& tree, const Key& k) {
+    tree.try_emplace(k, 1);
+}
+template<class Key>
+void add(map<Key, uint64_t>& tree, const Key& k) {
+    tree.try_emplace(k, 1);
+}
+template<class Tree, class Key>
+void drop(Tree& tree, const Key& k) {
+    tree.remove(k);
+}
+template<class Key>
+void drop(set<Key>& tree, const Key& k) {
+    tree.erase(k);
+}
+template<class Key>
+void drop(map<Key, uint64_t>& tree, const Key& k) {
+    tree.erase(k);
+}
+template<class Tree>
+uint64_t items(const Tree& tree) {
+    return tree.count();
+}
+template<class Key>
+uint64_t items(const set<Key>& tree) {
+    return tree.size();
+}
+template<class Key>
+uint64_t items(const map<Key, uint64_t>& tree) {
+    return tree.size();
+}
+///@brief reads an item, so that a scan cannot skip it
+uint64_t touch(uint64_t k) {
+    return k;
+}
+uint64_t touch(const string& k) {
+    return k.size() + k.back();
+}
+template<class Entry>
+uint64_t touch(const Entry& entry) {
+    return touch(entry.first);
+}
+
+///@brief makes the key numbered n, present keys are even and missing keys odd
+template<class Key>
+Key makeKey(uint64_t n);
+template<>
+uint64_t makeKey<uint64_t>(uint64_t n) {
+    return n;
+}
+template<>
+string makeKey<string>(uint64_t n) {
+    return "user:" + to_string(n);
+}
+
+///@brief Draws ranks below size, uniformly or from a Zipf distribution
+class RankDraw {
+private:
+    vector<double> cdf; ///< cdf[r] is the chance of drawing a rank <= r
+    uniform_real_distribution<double> draw;
+    uint32_t size;
+public:
+    RankDraw(uint32_t size, double skew) : size(size) {
+        if (skew > 0)
+        {
+            cdf.resize(size);
+            double total = 0;
+            for (uint32_t r = 0; r < size; r++)
+            {
+                total += pow(r + 1, -skew);
+                cdf[r] = total;
+            }
+            draw = uniform_real_distribution<double>(0, total);
+        }
+    }
+    uint32_t operator()(mt19937_64& rng) {
+        if (cdf.empty())
+            return rng() % size;
+        size_t rank = lower_bound(cdf.begin(), cdf.end(), draw(rng)) -
+                      cdf.begin();
+        return min<size_t>(rank, size - 1);
+    }
+};
+
+///@brief the time of one operation, from last to now, and moves last to now
+uint64_t lap(chrono::steady_clock::time_point& last) {
+    auto now = chrono::steady_clock::now();
+    uint64_t ns = chrono::duration_cast<chrono::nanoseconds>(now - last)
+                  .count();
+    last = now;
+    return ns;
+}
+
+/**@brief runs every phase of one workload on one container
+   @param tree an empty container
+   @param w the workload
+   @param present the keys LOAD inserts, in insert order
+   @param missing keys that are not loaded (churn inserts from these)
+   @param rank the index (in present and missing) of each Zipf rank
+   @return the timings of each phase
+*/
+template<class Tree, class Key>
+vector<Phase> run(Tree& tree, const Settings& s, const Workload& w,
+                  const vector<Key>& present, const vector<Key>& missing,
+                  const vector<uint32_t>& rank) {
+    vector<Phase> phases;
+    uint64_t sum = 0;
+
+    //plan the MIX phase before timing anything
+    mt19937_64 rng(7);
+    uniform_real_distribution<double> chance(0, 1);
+    RankDraw draw(s.size, w.zipf);
+    vector<pair<OpKind, const Key*>> plan(s.ops);
+    for (auto& op : plan)
+    {
+        double kind = chance(rng) * (w.reads + w.inserts + w.removes);
+        op.first = (kind < w.reads) ? READ
+                 : (kind < w.reads + w.inserts) ? INSERT : REMOVE;
+        uint32_t i = rank[draw(rng)];
+        bool hit = op.first != INSERT && chance(rng) < w.hit;
+        op.second = hit ? &present[i] : &missing[i];
+    }
+
+    Phase load = {"LOAD", present.size(), 0, {}};
+    load.ns.reserve(present.size());
+    auto start = chrono::steady_clock::now(), last = start;
+    for (const Key& k : present)
+    {
+        add(tree, k);
+        load.ns.push_back(lap(last));
+    }
+    load.seconds = since(start);
+    phases.push_back(load);
+
+    Phase mix = {"MIX", s.ops, 0, {}};
+    mix.ns.reserve(s.ops);
+    start = last = chrono::steady_clock::now();
+    for (const auto& op : plan)
+    {
+        if (op.first == READ)
+            sum += has(tree, *op.second);
+        else if (op.first == INSERT)
+            add(tree, *op.second);
+        else
+            drop(tree, *op.second);
+        mix.ns.push_back(lap(last));
+    }
+    mix.seconds = since(start);
+    phases.push_back(mix);
+
+    Phase copy = {"COPY", 0, 0, {}};
+    for (uint32_t r = 0; r < s.rounds; r++)
+    {
+        start = chrono::steady_clock::now();
+        Tree copied(tree);
+        double seconds = since(start);
+        copy.seconds += seconds;
+        copy.ns.push_back(seconds * 1e9);
+        copy.ops += items(copied);
+    }
+    phases.push_back(copy);
+
+    Phase scan = {"SCAN", 0, 0, {}};
+    for (uint32_t r = 0; r < s.rounds; r++)
+    {
+        start = chrono::steady_clock::now();
+        for (const auto& item : tree)
+            sum += touch(item);
+        double seconds = since(start);
+        scan.seconds += seconds;
+        scan.ns.push_back(seconds * 1e9);
+        scan.ops += items(tree);
+    }
+    phases.push_back(scan);
+
+    if (sum == 0) //never true, but keeps the lookups from being dropped
+        cerr << "Nothing was found" << endl;
+    return phases;
+}
+
+///@brief the latency that fraction p of the operations were at most
+uint64_t percentile(vector<uint64_t>& ns, double p) {
+    size_t i = min<size_t>(ns.size() - 1, p * ns.size());
+    nth_element(ns.begin(), ns.begin() + i, ns.end());
+    return ns[i];
+}
+
+/**@brief runs one workload on one container in a child process
+   @param label the container's and key's names, as CSV
+   @param make returns an empty container
+
+Appends the results to s.file, so a crash in one run leaves the rest of the
+report alone.
+*/
+template<class Key, class Make>
+void isolate(const Settings& s, const string& label, const Workload& w,
+             Make make) {
+    cout.flush(); //so the child does not print it again
+    pid_t child = fork();
+    if (child < 0)
+    {
+        cerr << label << "," << w.name << " could not start" << endl;
+        return;
+    }
+    if (child == 0)
+    {
+        vector<Key> present(s.size), missing(s.size);
+        for (uint32_t i = 0; i < s.size; i++)
+        {
+            present[i] = makeKey<Key>(2 * i);
+            missing[i] = makeKey<Key>(2 * i + 1);
+        }
+        if (w.order == SORTED)
+            sort(present.begin(), present.end());
+        else
+            shuffle(present.begin(), present.end(), mt19937(42));
+        //hot keys are spread over the key space, not next to each other
+        vector<uint32_t> rank(s.size);
+        for (uint32_t i = 0; i < s.size; i++)
+            rank[i] = i;
+        shuffle(rank.begin(), rank.end(), mt19937(3));
+
+        auto tree = make();
+        vector<Phase> phases = run(tree, s, w, present, missing, rank);
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+
+        ofstream out(s.file, ios::app);
+        for (Phase& p : phases)
+        {
+            if (p.ns.empty())
+                continue;
+            out << label << "," << w.name << "," << p.name << "," << p.ops
+                << "," << p.ops / p.seconds << ","
+                << percentile(p.ns, 0.5) << "," << percentile(p.ns, 0.99)
+                << "," << percentile(p.ns, 0.999) << ","
+                << *max_element(p.ns.begin(), p.ns.end()) << ","
+                << usage.ru_maxrss << endl;
+        }
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        cerr << label << "," << w.name << " failed" << endl;
+    else
+        cout << "Finished " << label << "," << w.name << "." << endl;
+}
+
+///@brief runs the selected workloads on every selected container
+template<class Key>
+void runKey(const Settings& s, const string& keyName) {
+    if (!s.key.empty() && s.key != keyName)
+        return;
+    for (const Workload& w : workloads)
+    {
+        if (!s.workload.empty() && s.workload != w.name)
+            continue;
+        auto pick = [&](const string& name) {
+            return s.container.empty() || s.container == name;
+        };
+        string key = "," + keyName;
+        if (pick("BINTREE"))
+            isolate<Key>(s, "BINTREE" + key, w,
+                         [] { return BinTree<Key>(RED_BLACK); });
+        if (pick("SPLAY"))
+            isolate<Key>(s, "SPLAY" + key, w,
+                         [] { return BinTree<Key>(SPLAY); });
+        if (pick("COMPACT"))
+            isolate<Key>(s, "COMPACT" + key, w,
+                         [] { return CompactBinTree<Key>(); });
+        if (pick("BTREE"))
+            isolate<Key>(s, "BTREE" + key, w, [] { return BTree<Key>(); });
+        if constexpr (is_same<Key, string>::value)
+        {
+            if (pick("RADIX"))
+                isolate<Key>(s, "RADIX" + key, w, [] { return RadixTrie(); });
+        }
+        if (pick("STD_SET"))
+            isolate<Key>(s, "STD_SET" + key, w, [] { return set<Key>(); });
+        if (pick("BINTREEMAP"))
+            isolate<Key>(s, "BINTREEMAP" + key, w,
+                         [] { return BinTreeMap<Key, uint64_t>(); });
+        if (pick("STD_MAP"))
+            isolate<Key>(s, "STD_MAP" + key, w,
+                         [] { return map<Key, uint64_t>(); });
+    }
+}
+
+/**@brief applies one name=value argument
+   @return false if name is unknown
+*/
+bool setOption(Settings& s, const string& name, const string& value) {
+    if (name == "size")
+        s.size = max(1ul, stoul(value));
+    else if (name == "ops")
+        s.ops = stoul(value);
+    else if (name == "rounds")
+        s.rounds = max(1ul, stoul(value));
+    else if (name == "key")
+        s.key = value;
+    else if (name == "container")
+        s.container = value;
+    else if (name == "workload")
+        s.workload = value;
+    else
+    {
+        for (Workload& w : workloads)
+        {
+            if (name == "order")
+                w.order = (value == "sorted") ? SORTED : RANDOM;
+            else if (name == "reads")
+                w.reads = stod(value);
+            else if (name == "inserts")
+                w.inserts = stod(value);
+            else if (name == "removes")
+                w.removes = stod(value);
+            else if (name == "hit")
+                w.hit = stod(value);
+            else if (name == "zipf")
+                w.zipf = stod(value);
+            else
+                return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Settings s;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        size_t equals = arg.find('=');
+        if (equals == string::npos)
+            s.file = arg;
+        else if (!setOption(s, arg.substr(0, equals), arg.substr(equals + 1)))
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 1;
+        }
+    }
+
+    {
+        ofstream out(s.file);
+        out << "container,key,workload,phase,ops,ops/sec,p50 ns,p99 ns,"
+            << "p99.9 ns,max ns,peak RSS KB" << endl;
+    }
+    runKey<uint64_t>(s, "INT64");
+    runKey<string>(s, "STRING");
+}
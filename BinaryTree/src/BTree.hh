@@ -0,0 +1,803 @@
+///@file BTree.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef BTREE_HH
+#define BTREE_HH
+
+#include <utility>
+#include <iterator>
+#include <initializer_list>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include "BinTree.hh" //for TreeTraverse
+#include "NodePool.hh"
+
+/**@brief the default number of items in a BTree node
+
+Enough items to fill about 4 cache lines (256 bytes), but never less than 8.
+*/
+template<class DataType>
+struct BTreeWidth {
+    static const int value = (256 / sizeof(DataType) < 8)
+                             ? 8 : 256 / sizeof(DataType);
+};
+
+/**@brief A B+ tree, a sorted container with the same interface as BinTree
+
+Instead of 1 item and 2 children per node, every node holds up to B items
+side by side in an array. A lookup only visits log_B(n) nodes instead of
+lg(n), and the items in a node share cache lines, so most of the work is done
+on memory that is already in the cache.
+
+* All of the data lives in the leaves, which are linked to each other in
+  order, so iterating or scanning a range never goes back up the tree
+* Interior nodes only hold copies of keys to guide searches (separators):
+  everything in children[i] is < keys[i] <= everything in children[i + 1]
+* Every node other than root is at least half full, so all leaves are at the
+  same level and the height is at most log_(B/2)(n) + 1
+* Searching within a node is a branchless linear scan: it counts how many
+  items are smaller than the key. There are no unpredictable branches, and
+  the compiler can turn the loop into SIMD instructions for number types.
+* DataType must be default constructible and copyable, since nodes are
+  arrays of DataType and separators are copies of items
+
+@tparam DataType the type of data to store, compared with <
+@tparam B the most items that a node can hold (at least 4)
+*/
+template<class DataType, int B = BTreeWidth<DataType>::value>
+class BTree {
+private:
+    static_assert(B >= 4, "BTree nodes must hold at least 4 items");
+    static const int minItems = B / 2; ///< non-root nodes hold at least this
+
+    ///@brief the part that leaves and interior nodes have in common
+    struct BNode {
+        uint16_t count = 0; ///< the number of items in use
+        bool leaf;
+        DataType keys[B];
+        explicit BNode(bool leaf) : leaf(leaf) {}
+    };
+    struct Leaf : BNode {
+        Leaf* prev = NULL;
+        Leaf* next = NULL;
+        Leaf() : BNode(true) {}
+    };
+    struct Interior : BNode {
+        BNode* children[B + 1];
+        Interior() : BNode(false) {}
+    };
+
+    ///@brief what a node passes up to its parent after it splits
+    struct Split {
+        DataType key;       ///< the separator for the new node
+        BNode* right;       ///< the new node, NULL if there was no split
+    };
+
+    BNode* root;
+    Leaf* head; ///< the leftmost leaf
+    Leaf* tail; ///< the rightmost leaf
+    uint32_t itemCount;
+    uint32_t levels;
+    NodePool<Leaf> leafPool;
+    NodePool<Interior> interiorPool;
+
+    Leaf* newLeaf();
+    Interior* newInterior();
+    void freeNode(BNode* n);
+    void delNode(BNode* n);
+
+    template<class Key>
+    static int lowerIndex(const BNode* n, const Key& key);
+    template<class Key>
+    static int upperIndex(const BNode* n, const Key& key);
+    template<class Key>
+    Leaf* findLeaf(const Key& key) const;
+
+    bool insert(BNode* n, const DataType& data, Split& split);
+    template<class Key>
+    bool remove(BNode* n, const Key& data);
+    void fixChild(Interior* parent, int i);
+public:
+    ///@brief A bidirectional iterator that visits the data in order
+    class iterator {
+    private:
+        Leaf* leaf; ///< NULL for end()
+        int i;
+        const BTree* tree; ///< needed to step back from end()
+        friend class BTree;
+        iterator(Leaf* leaf, int i, const BTree* tree)
+            : leaf(leaf), i(i), tree(tree) {}
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef DataType value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const DataType* pointer;
+        typedef const DataType& reference;
+
+        iterator() : leaf(NULL), i(0), tree(NULL) {}
+        reference operator*() const { return leaf->keys[i]; }
+        pointer operator->() const { return &leaf->keys[i]; }
+        iterator& operator++() {
+            if (++i == leaf->count)
+            {
+                leaf = leaf->next;
+                i = 0;
+            }
+            return *this;
+        }
+        iterator& operator--() {
+            if (leaf == NULL)
+            {
+                leaf = tree->tail;
+                i = leaf->count - 1;
+            }
+            else if (i == 0)
+            {
+                leaf = leaf->prev;
+                i = leaf->count - 1;
+            }
+            else
+                i--;
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+        iterator operator--(int) {
+            iterator old = *this;
+            --*this;
+            return old;
+        }
+        bool operator==(const iterator& right) const {
+            return leaf == right.leaf && i == right.i;
+        }
+        bool operator!=(const iterator& right) const {
+            return !(*this == right);
+        }
+    };
+    typedef iterator const_iterator;
+
+    ///@brief A pair of iterators that can be used in a range-based for loop
+    class Range {
+    private:
+        iterator first, last;
+    public:
+        Range(iterator first, iterator last) : first(first), last(last) {}
+        iterator begin() const { return first; }
+        iterator end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    BTree(); ///< default constructor
+    BTree(std::initializer_list<DataType> data);
+    ~BTree();
+    //MANAGE DATA//////////////////////////////////////////////
+    uint32_t count() const; ///< get the number of items in the tree
+    uint32_t height() const; ///< get the number of levels in the tree
+    void insert(const DataType& data);
+    void insert(std::initializer_list<DataType> data);
+    template<class Key>
+    const bool remove(const Key& data);
+    template<class Key>
+    const std::pair<bool, uint32_t> search(const Key& data) const;
+    void traverse(TreeTraverse order,
+                  void (*func)(const DataType&, uint32_t)) const;
+    void erase(); ///< erases the contents of the tree
+    //ITERATE//////////////////////////////////////////////////
+    iterator begin() const; ///< get the smallest item
+    iterator end() const; ///< get the position after the largest item
+    template<class Key>
+    iterator find(const Key& data) const;
+    template<class Key>
+    iterator lower_bound(const Key& data) const;
+    template<class Key>
+    iterator upper_bound(const Key& data) const;
+    Range range(const DataType& low, const DataType& high) const;
+    //COPY/////////////////////////////////////////////////////
+    BTree(const BTree& source);
+    BTree(BTree&& source);
+    BTree& operator=(const BTree& right);
+    BTree& operator=(BTree&& right);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+template<class DataType, int B>
+BTree<DataType, B>::BTree() {
+    root = NULL;
+    head = NULL;
+    tail = NULL;
+    itemCount = 0;
+    levels = 0;
+}
+
+///@brief starting value constructor, data may be in any order
+template<class DataType, int B>
+BTree<DataType, B>::BTree(std::initializer_list<DataType> data) : BTree() {
+    insert(data);
+}
+
+template<class DataType, int B>
+BTree<DataType, B>::~BTree() {
+    erase();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PUBLIC
+template<class DataType, int B>
+uint32_t BTree<DataType, B>::count() const {
+    return itemCount;
+}
+
+template<class DataType, int B>
+uint32_t BTree<DataType, B>::height() const {
+    return levels;
+}
+
+/**@brief adds data to the tree
+   @param data the data to add, duplicates are ignored
+
+The data goes into the leaf where it belongs. A full leaf splits in half, and
+the split is passed up to the parent, which may split as well. When root
+splits, the tree grows a new root, so every leaf stays on the same level.
+*/
+template<class DataType, int B>
+void BTree<DataType, B>::insert(const DataType& data) {
+    if (root == NULL)
+    {
+        head = tail = newLeaf();
+        root = head;
+        levels = 1;
+    }
+
+    Split split;
+    split.right = NULL;
+    if (!insert(root, data, split))
+        return;
+    itemCount++;
+
+    if (split.right != NULL)
+    {
+        Interior* top = newInterior();
+        top->keys[0] = split.key;
+        top->children[0] = root;
+        top->children[1] = split.right;
+        top->count = 1;
+        root = top;
+        levels++;
+    }
+}
+
+///@brief insert multiple pieces of data, in any order
+template<class DataType, int B>
+void BTree<DataType, B>::insert(std::initializer_list<DataType> data) {
+    for (const DataType& i : data)
+        insert(i);
+}
+
+/**@brief remove some data from the tree
+   @param data the data to remove (anything that compares with DataType)
+   @return true if the data was found and removed, false if the data
+           does not exist
+*/
+template<class DataType, int B>
+template<class Key>
+const bool BTree<DataType, B>::remove(const Key& data) {
+    if (root == NULL || !remove(root, data))
+        return false;
+    itemCount--;
+
+    //root has run out of separators, its only child becomes root
+    if (!root->leaf && root->count == 0)
+    {
+        BNode* old = root;
+        root = static_cast<Interior*>(root)->children[0];
+        freeNode(old);
+        levels--;
+    }
+    return true;
+}
+
+/**@brief searches the tree
+   @param data the data to search for
+   @return an std::pair<bool, uint32_t> of whether the data exists and the
+           level that it is on (always the leaf level, height() - 1)
+*/
+template<class DataType, int B>
+template<class Key>
+const std::pair<bool, uint32_t>
+BTree<DataType, B>::search(const Key& data) const {
+    if (find(data) == end())
+        return std::make_pair(false, 0);
+    return std::make_pair(true, levels - 1);
+}
+
+/**@brief runs a user-supplied function on every item in the tree
+   @param order IN_ORDER, PRE_ORDER or POST_ORDER
+   @param func the function to run on each item, with the item's level
+
+All of the data lives in the leaves, so every order visits the items in
+ascending order, all on the leaf level. The order is accepted so that code
+written for BinTree works unchanged.
+*/
+template<class DataType, int B>
+void BTree<DataType, B>::traverse(TreeTraverse order,
+                    void (*func)(const DataType&, uint32_t)) const {
+    (void)order;
+    for (Leaf* leaf = head; leaf != NULL; leaf = leaf->next)
+    {
+        for (int i = 0; i < leaf->count; i++)
+            func(leaf->keys[i], levels - 1);
+    }
+}
+
+/**@brief erases the contents of the tree
+
+Like BinTree::erase(), when DataType has a trivial destructor the node pools
+are released without visiting the nodes.
+*/
+template<class DataType, int B>
+void BTree<DataType, B>::erase() {
+    if (!std::is_trivially_destructible<DataType>::value && root != NULL)
+        delNode(root);
+    leafPool.release();
+    interiorPool.release();
+    root = NULL;
+    head = NULL;
+    tail = NULL;
+    itemCount = 0;
+    levels = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//ITERATE
+template<class DataType, int B>
+typename BTree<DataType, B>::iterator BTree<DataType, B>::begin() const {
+    if (itemCount == 0)
+        return end();
+    return iterator(head, 0, this);
+}
+
+template<class DataType, int B>
+typename BTree<DataType, B>::iterator BTree<DataType, B>::end() const {
+    return iterator(NULL, 0, this);
+}
+
+///@brief looks up data, returns end() if it does not exist
+template<class DataType, int B>
+template<class Key>
+typename BTree<DataType, B>::iterator
+BTree<DataType, B>::find(const Key& data) const {
+    iterator it = lower_bound(data);
+    if (it != end() && data < *it)
+        return end();
+    return it;
+}
+
+///@brief finds the first item >= data, end() if there is none
+template<class DataType, int B>
+template<class Key>
+typename BTree<DataType, B>::iterator
+BTree<DataType, B>::lower_bound(const Key& data) const {
+    Leaf* leaf = findLeaf(data);
+    if (leaf == NULL)
+        return end();
+    int i = lowerIndex(leaf, data);
+    if (i == leaf->count) //everything in this leaf is smaller
+    {
+        leaf = leaf->next;
+        i = 0;
+    }
+    return iterator(leaf, i, this);
+}
+
+///@brief finds the first item > data, end() if there is none
+template<class DataType, int B>
+template<class Key>
+typename BTree<DataType, B>::iterator
+BTree<DataType, B>::upper_bound(const Key& data) const {
+    Leaf* leaf = findLeaf(data);
+    if (leaf == NULL)
+        return end();
+    int i = upperIndex(leaf, data);
+    if (i == leaf->count)
+    {
+        leaf = leaf->next;
+        i = 0;
+    }
+    return iterator(leaf, i, this);
+}
+
+/**@brief gets every item from low to high (including both)
+
+Finding the start takes one descent, after that the scan walks along the
+leaves, reading up to B items from each one.
+*/
+template<class DataType, int B>
+typename BTree<DataType, B>::Range
+BTree<DataType, B>::range(const DataType& low, const DataType& high) const {
+    if (high < low)
+        return Range(end(), end());
+    return Range(lower_bound(low), upper_bound(high));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//COPY
+///@brief copy constructor, the items are inserted in order
+template<class DataType, int B>
+BTree<DataType, B>::BTree(const BTree& source) : BTree() {
+    for (const DataType& data : source)
+        insert(data);
+}
+
+///@brief move constructor, takes over source's nodes
+template<class DataType, int B>
+BTree<DataType, B>::BTree(BTree&& source) : BTree() {
+    *this = std::move(source);
+}
+
+template<class DataType, int B>
+BTree<DataType, B>& BTree<DataType, B>::operator=(const BTree& right) {
+    if (this == &right)
+        return *this;
+    erase();
+    for (const DataType& data : right)
+        insert(data);
+    return *this;
+}
+
+template<class DataType, int B>
+BTree<DataType, B>& BTree<DataType, B>::operator=(BTree&& right) {
+    if (this == &right)
+        return *this;
+    erase();
+    std::swap(root, right.root);
+    std::swap(head, right.head);
+    std::swap(tail, right.tail);
+    std::swap(itemCount, right.itemCount);
+    std::swap(levels, right.levels);
+    leafPool.swap(right.leafPool);
+    interiorPool.swap(right.interiorPool);
+    return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+template<class DataType, int B>
+typename BTree<DataType, B>::Leaf* BTree<DataType, B>::newLeaf() {
+    return new (leafPool.allocate()) Leaf;
+}
+
+template<class DataType, int B>
+typename BTree<DataType, B>::Interior* BTree<DataType, B>::newInterior() {
+    return new (interiorPool.allocate()) Interior;
+}
+
+///@brief destroys a single node and returns it to its pool
+template<class DataType, int B>
+void BTree<DataType, B>::freeNode(BNode* n) {
+    if (n->leaf)
+    {
+        Leaf* leaf = static_cast<Leaf*>(n);
+        leaf->~Leaf();
+        leafPool.deallocate(leaf);
+    }
+    else
+    {
+        Interior* interior = static_cast<Interior*>(n);
+        interior->~Interior();
+        interiorPool.deallocate(interior);
+    }
+}
+
+///@brief destroys a node and everything under it (the tree is log_B(n) deep)
+template<class DataType, int B>
+void BTree<DataType, B>::delNode(BNode* n) {
+    if (!n->leaf)
+    {
+        Interior* interior = static_cast<Interior*>(n);
+        for (int i = 0; i <= interior->count; i++)
+            delNode(interior->children[i]);
+    }
+    freeNode(n);
+}
+
+/**@brief counts the items in a node that are smaller than key
+   @return the index of the first item >= key (count if there is none)
+
+Every item is compared, and the results are added up instead of branched on.
+With only up to B items, this beats a binary search: there are no
+mispredicted branches, the items are read front to back, and the loop can be
+vectorized.
+*/
+template<class DataType, int B>
+template<class Key>
+int BTree<DataType, B>::lowerIndex(const BNode* n, const Key& key) {
+    int i = 0;
+    for (int k = 0; k < n->count; k++)
+        i += (n->keys[k] < key);
+    return i;
+}
+
+///@brief counts the items in a node that are <= key, see lowerIndex()
+template<class DataType, int B>
+template<class Key>
+int BTree<DataType, B>::upperIndex(const BNode* n, const Key& key) {
+    int i = 0;
+    for (int k = 0; k < n->count; k++)
+        i += !(key < n->keys[k]);
+    return i;
+}
+
+///@brief finds the leaf that key belongs in, NULL if the tree is empty
+template<class DataType, int B>
+template<class Key>
+typename BTree<DataType, B>::Leaf*
+BTree<DataType, B>::findLeaf(const Key& key) const {
+    BNode* n = root;
+    if (n == NULL)
+        return NULL;
+    while (!n->leaf)
+        n = static_cast<Interior*>(n)->children[upperIndex(n, key)];
+    return static_cast<Leaf*>(n);
+}
+
+/**@brief adds data below a node, splitting nodes that overflow
+   @param n the node to insert below
+   @param data the data to add
+   @param split set to the new right half (and its separator) if n split
+   @return false if data is a duplicate
+
+The recursion is only as deep as the tree (log_B(n)).
+*/
+template<class DataType, int B>
+bool BTree<DataType, B>::insert(BNode* n, const DataType& data, Split& split) {
+    split.right = NULL;
+    int i;
+
+    if (n->leaf)
+    {
+        i = lowerIndex(n, data);
+        if (i < n->count && !(data < n->keys[i]))
+            return false;
+    }
+    else
+    {
+        Interior* interior = static_cast<Interior*>(n);
+        i = upperIndex(n, data);
+        Split below;
+        if (!insert(interior->children[i], data, below))
+            return false;
+        if (below.right == NULL)
+            return true;
+
+        //the child split, its separator goes in at i, the new child at i + 1
+        if (n->count < B)
+        {
+            for (int k = n->count; k > i; k--)
+            {
+                n->keys[k] = n->keys[k - 1];
+                interior->children[k + 1] = interior->children[k];
+            }
+            n->keys[i] = below.key;
+            interior->children[i + 1] = below.right;
+            n->count++;
+            return true;
+        }
+
+        //full: lay out all B + 1 separators and B + 2 children, then split
+        //them around the middle separator, which moves up to the parent
+        DataType keys[B + 1];
+        BNode* children[B + 2];
+        for (int k = 0, from = 0; k <= B; k++)
+            keys[k] = (k == i) ? below.key : n->keys[from++];
+        for (int k = 0, from = 0; k <= B + 1; k++)
+            children[k] = (k == i + 1) ? below.right
+                                       : interior->children[from++];
+
+        const int mid = (B + 1) / 2;
+        Interior* right = newInterior();
+        n->count = mid;
+        for (int k = 0; k < mid; k++)
+        {
+            n->keys[k] = keys[k];
+            interior->children[k] = children[k];
+        }
+        interior->children[mid] = children[mid];
+        right->count = B - mid;
+        for (int k = 0; k < right->count; k++)
+        {
+            right->keys[k] = keys[mid + 1 + k];
+            right->children[k] = children[mid + 1 + k];
+        }
+        right->children[right->count] = children[B + 1];
+
+        split.key = keys[mid];
+        split.right = right;
+        return true;
+    }
+
+    //leaf with room
+    if (n->count < B)
+    {
+        for (int k = n->count; k > i; k--)
+            n->keys[k] = n->keys[k - 1];
+        n->keys[i] = data;
+        n->count++;
+        return true;
+    }
+
+    //full leaf: the upper half moves to a new leaf, then data goes in
+    //whichever half it belongs to
+    Leaf* leaf = static_cast<Leaf*>(n);
+    Leaf* right = newLeaf();
+    const int half = (B + 1) / 2;
+    for (int k = half; k < B; k++)
+        right->keys[k - half] = leaf->keys[k];
+    right->count = B - half;
+    leaf->count = half;
+
+    BNode* target = leaf;
+    if (i > half)
+    {
+        target = right;
+        i -= half;
+    }
+    for (int k = target->count; k > i; k--)
+        target->keys[k] = target->keys[k - 1];
+    target->keys[i] = data;
+    target->count++;
+
+    right->next = leaf->next;
+    right->prev = leaf;
+    if (leaf->next != NULL)
+        leaf->next->prev = right;
+    else
+        tail = right;
+    leaf->next = right;
+
+    split.key = right->keys[0];
+    split.right = right;
+    return true;
+}
+
+/**@brief removes data from below a node, fixing any child that gets too small
+   @param n the node to remove from
+   @param data the data to remove
+   @return false if data was not found
+*/
+template<class DataType, int B>
+template<class Key>
+bool BTree<DataType, B>::remove(BNode* n, const Key& data) {
+    if (n->leaf)
+    {
+        int i = lowerIndex(n, data);
+        if (i == n->count || data < n->keys[i])
+            return false;
+        for (int k = i + 1; k < n->count; k++)
+            n->keys[k - 1] = n->keys[k];
+        n->count--;
+        return true;
+    }
+
+    Interior* interior = static_cast<Interior*>(n);
+    int i = upperIndex(n, data);
+    if (!remove(interior->children[i], data))
+        return false;
+    if (interior->children[i]->count < minItems)
+        fixChild(interior, i);
+    return true;
+}
+
+/**@brief refills a child that has fewer than minItems items
+   @param parent the child's parent
+   @param i the index of the child
+
+If a sibling can spare an item, one item moves over (through the parent's
+separator for interior nodes). Otherwise the child is merged with a sibling,
+which takes a separator out of the parent.
+*/
+template<class DataType, int B>
+void BTree<DataType, B>::fixChild(Interior* parent, int i) {
+    BNode* child = parent->children[i];
+    BNode* left = (i > 0) ? parent->children[i - 1] : NULL;
+    BNode* right = (i < parent->count) ? parent->children[i + 1] : NULL;
+
+    if (left != NULL && left->count > minItems) //borrow from the left
+    {
+        for (int k = child->count; k > 0; k--)
+            child->keys[k] = child->keys[k - 1];
+        if (child->leaf)
+        {
+            child->keys[0] = left->keys[left->count - 1];
+            parent->keys[i - 1] = child->keys[0];
+        }
+        else
+        {
+            Interior* c = static_cast<Interior*>(child);
+            Interior* l = static_cast<Interior*>(left);
+            for (int k = child->count + 1; k > 0; k--)
+                c->children[k] = c->children[k - 1];
+            c->children[0] = l->children[left->count];
+            child->keys[0] = parent->keys[i - 1];
+            parent->keys[i - 1] = left->keys[left->count - 1];
+        }
+        child->count++;
+        left->count--;
+        return;
+    }
+
+    if (right != NULL && right->count > minItems) //borrow from the right
+    {
+        if (child->leaf)
+        {
+            child->keys[child->count] = right->keys[0];
+            for (int k = 1; k < right->count; k++)
+                right->keys[k - 1] = right->keys[k];
+            parent->keys[i] = right->keys[0];
+        }
+        else
+        {
+            Interior* c = static_cast<Interior*>(child);
+            Interior* r = static_cast<Interior*>(right);
+            child->keys[child->count] = parent->keys[i];
+            c->children[child->count + 1] = r->children[0];
+            parent->keys[i] = right->keys[0];
+            for (int k = 1; k < right->count; k++)
+                right->keys[k - 1] = right->keys[k];
+            for (int k = 1; k <= right->count; k++)
+                r->children[k - 1] = r->children[k];
+        }
+        child->count++;
+        right->count--;
+        return;
+    }
+
+    //merge: always fold the right node of the pair into the left one
+    if (left == NULL)
+    {
+        left = child;
+        i++;
+    }
+    right = parent->children[i];
+
+    if (left->leaf)
+    {
+        for (int k = 0; k < right->count; k++)
+            left->keys[left->count + k] = right->keys[k];
+        left->count += right->count;
+
+        Leaf* l = static_cast<Leaf*>(left);
+        Leaf* r = static_cast<Leaf*>(right);
+        l->next = r->next;
+        if (r->next != NULL)
+            r->next->prev = l;
+        else
+            tail = l;
+    }
+    else
+    {
+        Interior* l = static_cast<Interior*>(left);
+        Interior* r = static_cast<Interior*>(right);
+        left->keys[left->count] = parent->keys[i - 1];
+        for (int k = 0; k < right->count; k++)
+            left->keys[left->count + 1 + k] = right->keys[k];
+        for (int k = 0; k <= right->count; k++)
+            l->children[left->count + 1 + k] = r->children[k];
+        left->count += right->count + 1;
+    }
+    freeNode(right);
+
+    //take separator i - 1 and child i out of the parent
+    for (int k = i; k < parent->count; k++)
+    {
+        parent->keys[k - 1] = parent->keys[k];
+        parent->children[k] = parent->children[k + 1];
+    }
+    parent->count--;
+}
+
+#endif // BTREE_HH
@@ -6,10 +6,21 @@
 
 #include <ios>
 #include <utility>
+#include <iterator>
+#include <vector>
+#include <algorithm>
 #include <initializer_list>
 #include <cstdint>
 #include <cstddef>
 #include <cstdarg>
+#include <new>
+#include <type_traits>
+#include <thread>
+#include <atomic>
+#include "NodePool.hh"
+#include "FrozenBinTree.hh"
+#include "TreeStats.hh"
+#include "BloomFilter.hh"
 
 template<class dataType>
 class BinTree;
@@ -20,48 +31,283 @@ BinTree<DataType> operator+(const BinTree<DataType>& left,
 
 template<class DataType>
 struct Node {
+    ///@brief builds data in place from any arguments DataType accepts
+    template<class... Args>
+    explicit Node(Args&&... args) : data(std::forward<Args>(args)...) {}
+
     DataType data;
     Node<DataType>* left = NULL;
     Node<DataType>* right = NULL;
+    Node<DataType>* parent = NULL;
+    bool red = false; ///< only used by RED_BLACK trees
+    uint32_t size = 1; ///< the number of nodes in this subtree (including this)
 };
 
 enum TreeTraverse {IN_ORDER, PRE_ORDER, POST_ORDER};
 
+/**@brief How a tree keeps itself balanced
+
+* UNBALANCED: a plain binary search tree, the shape depends on the order the
+  data is inserted in (sorted data builds a linked list)
+* RED_BLACK: a red-black tree, the height never exceeds 2*lg(n + 1) no matter
+  what order the data is inserted in
+* SPLAY: a splay tree, every node that is inserted, searched for or removed
+  next to is rotated all the way up to root. Items that are used often stay
+  near the top, so skewed lookups (a few hot keys) cost far less than lg(n),
+  and any sequence of operations costs O(lg n) each on average, although a
+  single one can take O(n).
+* SEMI_SPLAY: like SPLAY, but a node only climbs about half of the way to
+  root each time, so fewer rotations are done per access and a key needs a
+  few accesses before it reaches the top.
+
+Only insert(), emplace(), search() and remove() reshape a SPLAY or
+SEMI_SPLAY tree. Const lookups (find(), lower_bound(), the iterators...)
+leave it as it is, so they can still run from several threads at once.
+*/
+enum TreeBalance {UNBALANCED, RED_BLACK, SPLAY, SEMI_SPLAY};
+
 ///@brief A binary tree template
 template<class DataType>
 class BinTree {
 private:
     Node<DataType>* root; ///< the starting node
     uint32_t nodeCount; ///< the number of nodes in the tree
+    TreeBalance balance; ///< the balancing scheme, set on construction
+    NodePool<Node<DataType> > pool; ///< where the nodes are allocated
+    static const uint32_t batchLanes = 16; ///< searches run by searchBatch()
+    ///set operations only hand ranges at least this big to another thread
+    static const size_t forkMinimum = 4096;
+    mutable TreeCounter compareCount; ///< see TreeStats for the counters
+    TreeCounter allocCount;
+    TreeCounter rotateCount;
+    mutable TreeCounter filterCount;
+    BloomFilter filter; ///< only enabled by enableFilter()
+    static const uint32_t minFilterKeys = 1024; ///< the smallest filter size
+#ifdef BINTREE_STATS
+    mutable OpTimer insertTimer, searchTimer, removeTimer;
+#endif
+    template<class... Args>
+    Node<DataType>* newNode(Args&&... args);
+    Node<DataType>* cloneNode(const Node<DataType>* n);
+    void freeNode(Node<DataType>* n);
+    void swapContents(BinTree<DataType>& other);
     void delNode(Node<DataType>* n);
-    bool remove(Node<DataType>** n2d);
-    
-    const std::pair<Node<DataType>**, uint32_t>
-    search(const DataType& data, Node<DataType>*& n, uint32_t level) const;
-    
-    static void inOrder(void (*func)(const DataType&, uint32_t),
-                        Node<DataType>* n, uint32_t level);
-    static void preOrder(void (*func)(const DataType&, uint32_t),
-                         Node<DataType>* n, uint32_t level);
-    static void preOrder(Node<DataType>* n, BinTree<DataType>& dest);
-    static void postOrder(void (*func)(const DataType&, uint32_t),
-                          Node<DataType>* n, uint32_t level);
+    void remove(Node<DataType>* n2d);
+    template<class Key>
+    Node<DataType>* findSlot(const Key& data, Node<DataType>*& parent);
+    void attach(Node<DataType>* nn, Node<DataType>* parent);
+    template<class Key>
+    Node<DataType>* findNode(const Key& data, uint32_t& level,
+                             Node<DataType>** last = NULL) const;
+    template<class Key>
+    Node<DataType>* lowerNode(const Key& data) const;
+    template<class Key>
+    Node<DataType>* upperNode(const Key& data) const;
+    template<class Key>
+    uint32_t countBelow(const Key& data, bool inclusive) const;
+    static uint32_t sizeOf(const Node<DataType>* n);
+
+    void transplant(Node<DataType>* n, Node<DataType>* child);
+    void rotateLeft(Node<DataType>* n);
+    void rotateRight(Node<DataType>* n);
+    void rotateUp(Node<DataType>* n);
+    void splay(Node<DataType>* n);
+    void insertFixup(Node<DataType>* n);
+    void removeFixup(Node<DataType>* n, Node<DataType>* parent);
+
+    template<class Visit>
+    static bool walk(TreeTraverse order, Node<DataType>* n, Visit visit);
+    template<class Visit, class... Args>
+    static bool keepGoing(Visit& visit, Args&&... args);
+    uint32_t splitTasks(size_t want, std::vector<Node<DataType>*>& tasks,
+                        std::vector<std::pair<Node<DataType>*, uint32_t> >&
+                        above) const;
+    template<class Task>
+    static void runTasks(size_t taskCount, unsigned threads, Task task);
+
+    Node<DataType>* clone(const Node<DataType>* n);
+    void buildFrom(const std::vector<const DataType*>& items);
+    Node<DataType>* buildRange(const std::vector<const DataType*>& items,
+                               size_t first, size_t last,
+                               uint32_t level, uint32_t redLevel);
+    void flatten(std::vector<const DataType*>& items) const;
+    void mergeBuild(const BinTree<DataType>& a,
+                    const std::vector<const DataType*>& b);
+
+    ///@brief a detached RED_BLACK subtree, for split and join
+    struct Subtree {
+        Node<DataType>* root = NULL;
+        uint32_t blackHeight = 0; ///< black nodes on every path down
+    };
+    static bool isRed(const Node<DataType>* n);
+    static uint32_t blackHeight(const Node<DataType>* n);
+    static Node<DataType>* link(Node<DataType>* l, Node<DataType>* m,
+                                Node<DataType>* r, bool red);
+    Node<DataType>* joinRight(Node<DataType>* l, uint32_t lHeight,
+                              Node<DataType>* m, Node<DataType>* r,
+                              uint32_t rHeight);
+    Node<DataType>* joinLeft(Node<DataType>* l, uint32_t lHeight,
+                             Node<DataType>* m, Node<DataType>* r,
+                             uint32_t rHeight);
+    Subtree joinSub(Subtree l, Node<DataType>* m, Subtree r);
+    Subtree joinSub(Subtree l, Subtree r);
+    template<class Key>
+    Node<DataType>* splitSub(Subtree t, const Key& key,
+                             Subtree& l, Subtree& r);
+    Subtree unionSub(Subtree t, const std::vector<Node<DataType>*>& add,
+                     size_t first, size_t last,
+                     std::vector<Node<DataType>*>& dropped, uint32_t forks);
+    Subtree filterSub(Subtree t, const std::vector<const DataType*>& items,
+                      size_t first, size_t last, bool keep,
+                      std::vector<Node<DataType>*>& dropped, uint32_t forks);
+    void setRoot(Subtree t, const std::vector<Node<DataType>*>& dropped);
+    void filterBuild(const std::vector<const DataType*>& items, bool keep);
+    template<class Left, class Right>
+    static void forkJoin(bool fork, Left left, Right right);
+    static uint32_t forksFor(unsigned threads);
+
+    template<class Key>
+    bool filterRejects(const Key& data) const;
+    void filterAdd(const DataType& data);
+    void fillFilter(double falsePositiveRate);
+    void checkFilter();
+
+    static Node<DataType>* leftmost(Node<DataType>* n);
+    static Node<DataType>* rightmost(Node<DataType>* n);
+    static Node<DataType>* successor(Node<DataType>* n);
+    static Node<DataType>* predecessor(Node<DataType>* n);
 public:
-    BinTree(); ///< default constructor
-    BinTree(std::initializer_list<DataType> data);
+    /**@brief A bidirectional iterator that visits the data in order
+
+    The data is read-only, changing it could break the order of the tree.
+    Iterators stay valid until the node they point to is removed (nodes are
+    never moved once they are inserted), or the tree is erased. Moving to the
+    next or previous node follows parent pointers, so no stack is needed, and
+    walking the whole tree costs O(n) in total.
+    */
+    class iterator {
+    private:
+        Node<DataType>* n; ///< the current node, NULL for end()
+        const BinTree<DataType>* tree; ///< needed to step back from end()
+        friend class BinTree<DataType>;
+        iterator(Node<DataType>* n, const BinTree<DataType>* tree)
+            : n(n), tree(tree) {}
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef DataType value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const DataType* pointer;
+        typedef const DataType& reference;
+
+        iterator() : n(NULL), tree(NULL) {}
+        reference operator*() const { return n->data; }
+        pointer operator->() const { return &n->data; }
+        iterator& operator++() {
+            n = successor(n);
+            return *this;
+        }
+        iterator& operator--() {
+            n = (n == NULL) ? rightmost(tree->root) : predecessor(n);
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+        iterator operator--(int) {
+            iterator old = *this;
+            --*this;
+            return old;
+        }
+        bool operator==(const iterator& right) const { return n == right.n; }
+        bool operator!=(const iterator& right) const { return n != right.n; }
+    };
+    typedef iterator const_iterator;
+
+    ///@brief A pair of iterators that can be used in a range-based for loop
+    class Range {
+    private:
+        iterator first, last;
+    public:
+        Range(iterator first, iterator last) : first(first), last(last) {}
+        iterator begin() const { return first; }
+        iterator end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    BinTree(TreeBalance balance = UNBALANCED); ///< default constructor
+    BinTree(std::initializer_list<DataType> data,
+            TreeBalance balance = UNBALANCED);
     ~BinTree();
     //MANAGE DATA//////////////////////////////////////////////
     uint32_t count() const; ///< get the number of items in the tree
+    uint32_t height() const;
+    TreeBalance getBalance() const; ///< get the balancing scheme
     void insert(const DataType& data);
+    void insert(DataType&& data);
     void insert(std::initializer_list<DataType> data);
-    const bool remove(const DataType& data);
-    const std::pair<bool, uint32_t> search(const DataType& data); //search
-    void traverse(TreeTraverse order, void (*func)(const DataType&, uint32_t)) const;
+    template<class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    template<class Key, class... Args>
+    std::pair<iterator, bool> emplaceKey(const Key& key, Args&&... args);
+    template<class Key>
+    const bool remove(const Key& data);
+    template<class Key>
+    const std::pair<bool, uint32_t> search(const Key& data); //search
+    template<class Visit>
+    bool traverse(TreeTraverse order, Visit&& visit) const;
     void erase(); ///< erases the contents of the tree
+    template<class Iter>
+    void build(Iter first, Iter last);
+    template<class Iter>
+    void insertBatch(Iter first, Iter last);
+    template<class Iter, class OutIter>
+    void searchBatch(Iter first, Iter last, OutIter results) const;
+    //ITERATE//////////////////////////////////////////////////
+    iterator begin() const; ///< get the smallest item
+    iterator end() const; ///< get the position after the largest item
+    template<class Key>
+    iterator find(const Key& data) const;
+    template<class Key>
+    iterator lower_bound(const Key& data) const;
+    template<class Key>
+    iterator upper_bound(const Key& data) const;
+    Range range(const DataType& low, const DataType& high) const;
+    //ORDER STATISTICS/////////////////////////////////////////
+    iterator select(uint32_t k) const;
+    template<class Key>
+    uint32_t rank(const Key& data) const;
+    uint32_t countInRange(const DataType& low, const DataType& high) const;
+    //SET OPERATIONS///////////////////////////////////////////
+    void unionWith(const BinTree<DataType>& other, unsigned threads = 1);
+    void intersectWith(const BinTree<DataType>& other, unsigned threads = 1);
+    void subtract(const BinTree<DataType>& other, unsigned threads = 1);
+    template<class Key>
+    BinTree<DataType> split(const Key& key);
+    bool join(const DataType& key, BinTree<DataType>& right);
+    //PARALLEL////////////////////////////////////////////////
+    template<class Visit>
+    void parallelTraverse(Visit visit, unsigned threads = 0) const;
+    template<class Result, class Map, class Combine>
+    Result parallelReduce(Result identity, Map map, Combine combine,
+                          unsigned threads = 0) const;
+    //FILTER///////////////////////////////////////////////////
+    template<class T = DataType,
+             class = typename std::enable_if<IsHashable<T>::value>::type>
+    void enableFilter(double falsePositiveRate = 0.01);
+    void disableFilter(); ///< drops the filter and frees its memory
+    size_t filterMemory() const; ///< get the bytes the filter takes, or 0
+    //STATS////////////////////////////////////////////////////
+    TreeStats stats() const;
+    void resetStats(); ///< sets every counter (and timing) back to 0
+    //SNAPSHOT/////////////////////////////////////////////////
+    FrozenBinTree<DataType> freeze() const;
     //COPY/////////////////////////////////////////////////////
     BinTree(const BinTree<DataType>& source); ///< copy constructor
-    void operator=(const BinTree<DataType>& right); ///< overwrites the contents
-                                                    ///  of the tree
+    BinTree(BinTree<DataType>&& source);
+    BinTree<DataType>& operator=(const BinTree<DataType>& right);
+    BinTree<DataType>& operator=(BinTree<DataType>&& right);
     void operator+=(const BinTree<DataType>& right);
     friend BinTree<DataType> operator+ <>(const BinTree<DataType>& left,
                                           const BinTree<DataType>& right);
@@ -69,26 +315,33 @@ public:
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
+/**@brief default constructor
+   @param balance the balancing scheme to use, UNBALANCED by default
+*/
 template<class DataType>
-BinTree<DataType>::BinTree() {
+BinTree<DataType>::BinTree(TreeBalance balance) {
     root = NULL;
     nodeCount = 0;
+    this->balance = balance;
 }
 
 /**@brief starting value constructor
-   @param data a list of values of DataType to insert into the tree,
-          the first value becomes root
+   @param data a list of values of DataType to insert into the tree, in any
+          order, the tree is built perfectly balanced
+   @param balance the balancing scheme to use, UNBALANCED by default
 */
 template<class DataType>
-BinTree<DataType>::BinTree(std::initializer_list<DataType> data) {
+BinTree<DataType>::BinTree(std::initializer_list<DataType> data,
+                           TreeBalance balance) {
     root = NULL;
     nodeCount = 0;
+    this->balance = balance;
     insert(data);
 }
 
 template<class DataType>
 BinTree<DataType>::~BinTree() {
-    delNode(root);
+    erase();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -100,67 +353,147 @@ uint32_t BinTree<DataType>::count() const {
     return nodeCount;
 }
 
+/**@brief Get the number of levels in the tree
+   @return the number of nodes on the longest path from root to a leaf,
+           0 if the tree is empty
+*/
+template<class DataType>
+uint32_t BinTree<DataType>::height() const {
+    uint32_t h = 0;
+    walk(PRE_ORDER, root, [&h](Node<DataType>*, uint32_t level) {
+        if (level + 1 > h)
+            h = level + 1;
+    });
+    return h;
+}
+
+template<class DataType>
+TreeBalance BinTree<DataType>::getBalance() const {
+    return balance;
+}
+
 /**@brief adds data to the tree
    @param data the data to add
+
+The node is only allocated (and data copied) once the data is known not to be
+a duplicate.
 */
 template<class DataType>
 void BinTree<DataType>::insert(const DataType& data) {
-    Node<DataType>* nn = new Node<DataType>;
-    nn->data = data;
-
-    if (root == NULL)
-        root = nn;
-    else
-    {
-        Node<DataType>* current = root;
-        Node<DataType>* parent;
-
-        //find the parent of nn
-        while (current != NULL)
-        {
-            parent = current;
-            if (nn->data < current->data)
-                current = current->left;
-            else if (nn->data > current->data)
-                current = current->right;
-            else
-            {
-                delete nn;
-                return;
-            }
-        }
+    BINTREE_TIME(insertTimer);
+    Node<DataType>* parent;
+    if (findSlot(data, parent) == NULL)
+        attach(newNode(data), parent);
+}
 
-        //adjust parent pointers
-        if (nn->data < parent->data)
-            parent->left = nn;
-        else
-            parent->right = nn;
-    }
-    nodeCount++;
+/**@brief adds data to the tree, moving it into the node instead of copying
+   @param data the data to add, left unchanged if it is a duplicate
+*/
+template<class DataType>
+void BinTree<DataType>::insert(DataType&& data) {
+    BINTREE_TIME(insertTimer);
+    Node<DataType>* parent;
+    if (findSlot(data, parent) == NULL)
+        attach(newNode(std::move(data)), parent);
 }
 
 /**@brief insert multiple pieces of data, copies by value
    @param data the data to add (in a brace-enclosed initializer list)
 
+The list is sorted, then merged with the tree and rebuilt perfectly balanced,
+the same way as operator+=(). The order of the list does not matter.
+
 NOTE: this is not reccomended for anything that uses large amounts of memory
 */
 template<class DataType>
 void BinTree<DataType>::insert(std::initializer_list<DataType> data) {
-    for (DataType i : data) //for DataType i in list data
-        insert(i);
+    std::vector<const DataType*> sorted;
+    sorted.reserve(data.size());
+    for (const DataType& i : data) //for DataType i in list data
+        sorted.push_back(&i);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const DataType* a, const DataType* b) { return *a < *b; });
+
+    mergeBuild(*this, sorted);
+}
+
+/**@brief builds data directly in a new node, then adds it to the tree
+   @param args the arguments for one of DataType's constructors
+   @return an iterator to the data in the tree, and false if it was a
+           duplicate (the iterator points to the item that was already there)
+
+The data has to exist before it can be compared, so the node is always
+built. If the data turns out to be a duplicate, the node is thrown away.
+
+~~~~~{.cc}
+BinTree<string> names;
+names.emplace(5, 'x'); //adds "xxxxx" without a temporary string
+~~~~~
+*/
+template<class DataType>
+template<class... Args>
+std::pair<typename BinTree<DataType>::iterator, bool>
+BinTree<DataType>::emplace(Args&&... args) {
+    BINTREE_TIME(insertTimer);
+    Node<DataType>* nn = newNode(std::forward<Args>(args)...);
+    Node<DataType>* parent;
+    Node<DataType>* found = findSlot(nn->data, parent);
+    if (found == NULL)
+    {
+        attach(nn, parent);
+        return std::make_pair(iterator(nn, this), true);
+    }
+    freeNode(nn);
+    return std::make_pair(iterator(found, this), false);
+}
+
+/**@brief builds data in a new node only if nothing equal to key is there yet
+   @param key what the new data will compare equal to (anything that can be
+          compared with DataType using <, in both directions)
+   @param args the arguments for one of DataType's constructors, the data
+          they build must compare equal to key
+   @return an iterator to the data with that key, and true if it was added
+
+Unlike emplace(), the search happens first, using only the key, so nothing is
+built for a duplicate. This is what BinTreeMap::try_emplace() is built on.
+*/
+template<class DataType>
+template<class Key, class... Args>
+std::pair<typename BinTree<DataType>::iterator, bool>
+BinTree<DataType>::emplaceKey(const Key& key, Args&&... args) {
+    BINTREE_TIME(insertTimer);
+    Node<DataType>* parent;
+    Node<DataType>* found = findSlot(key, parent);
+    if (found != NULL)
+        return std::make_pair(iterator(found, this), false);
+
+    Node<DataType>* nn = newNode(std::forward<Args>(args)...);
+    attach(nn, parent);
+    return std::make_pair(iterator(nn, this), true);
 }
 
 /**@brief remove some data from the list
-   @param data the data to remove
+   @param data the data to remove, anything that can be compared with
+          DataType using < (in both directions)
    @return true if the data was found and removed, false if the data
            does not exist
 */
 template<class DataType>
-const bool BinTree<DataType>::remove(const DataType& data) {
-    Node<DataType>** n2d = search(data, root, 0).first;
-    if (*n2d == NULL)
+template<class Key>
+const bool BinTree<DataType>::remove(const Key& data) {
+    BINTREE_TIME(removeTimer);
+    if (filterRejects(data))
+        return false;
+    uint32_t level;
+    Node<DataType>* last;
+    Node<DataType>* n2d = findNode(data, level, &last);
+    if (n2d == NULL)
+    {
+        splay(last);
         return false;
-    return remove(n2d);
+    }
+    remove(n2d);
+    return true;
 }
 
 /**@brief performs a binary search of the tree
@@ -170,336 +503,2308 @@ const bool BinTree<DataType>::remove(const DataType& data) {
 
 * If the data was not found, the first value is false. Disregard the level
 * The level index starts at 0
+* data can be anything that can be compared with DataType using < (in both
+  directions), so a BinTree<std::string> can be searched with a
+  std::string_view or a const char* without building a temporary string
+* In a SPLAY or SEMI_SPLAY tree, the node that was found (or the last node
+  compared with, if there is none) is moved up afterwards. The level is
+  where the data was before it moved.
+* With a filter (see enableFilter()), most misses return without touching
+  the tree at all (and without splaying)
 */
 template<class DataType>
-const std::pair<bool, uint32_t> BinTree<DataType>::search(const DataType& data) {
-    const auto result = search(data, root, 0); //infers type during compile
-    if (*(result.first) == NULL)
+template<class Key>
+const std::pair<bool, uint32_t> BinTree<DataType>::search(const Key& data) {
+    BINTREE_TIME(searchTimer);
+    if (filterRejects(data))
+        return std::make_pair(false, 0);
+    uint32_t level;
+    Node<DataType>* last;
+    Node<DataType>* found = findNode(data, level, &last);
+    splay(last);
+    if (found == NULL)
         return std::make_pair(false, 0);
     else
-        return std::make_pair(true, result.second);
+        return std::make_pair(true, level);
 }
 
 /**@brief runs a user-supplied function on every node in the tree in the
           specified order
-   @param the order the order in which to hit each node, options are
+   @param order the order in which to hit each node, options are
           IN_ORDER, PRE_ORDER, and POST_ORDER; see below for what each does
-   @param void (*func)(const DataType&, uint32_t the function to run on each
-          node, the passed function must have the same parameter and return types
+   @param visit the function, lambda or functor to run on each node, called
+          as visit(const DataType& data, uint32_t level). If it returns a
+          bool, returning false stops the traversal.
+   @return false if visit stopped the traversal early
+
+* IN_ORDER, PRE_ORDER, POST_ORDER: see walk()
+
+visit is a template parameter, so the compiler can inline it into the walk,
+and a lambda can keep its state in its captures instead of in globals.
+
+~~~~~{.cc}
+//print the first 3 items
+int printed = 0;
+tree.traverse(IN_ORDER, [&printed](const string& s, uint32_t) {
+    cout << s << endl;
+    return ++printed < 3;
+});
+~~~~~
+*/
+template<class DataType>
+template<class Visit>
+bool BinTree<DataType>::traverse(TreeTraverse order, Visit&& visit) const {
+    return walk(order, root, [&visit](Node<DataType>* n, uint32_t level) {
+        return keepGoing(visit, static_cast<const DataType&>(n->data), level);
+    });
+}
 
-* IN_ORDER: see inOrder()
-* PRE_ORDER: see preOrder(void (*func)(const DataType&, uint32_t),
-                          Node<DataType>* n, uint32_t level)
-* POST_ORDER: see postOrder()
+/**@brief replaces the contents of the tree with sorted data
+   @param first an iterator to the first item to add
+   @param last an iterator to the position after the last item
+
+The data must be in ascending order (any duplicates are skipped). The tree is
+built perfectly balanced in O(n), without comparing the data to find where it
+goes. Iter must be a forward iterator (pointers, vector or set iterators...),
+the data may come from this tree.
+
+~~~~~{.cc}
+vector<int> ids = {1, 2, 3, 5, 8, 13};
+BinTree<int> tree(RED_BLACK);
+tree.build(ids.begin(), ids.end());
+~~~~~
 */
 template<class DataType>
-void BinTree<DataType>::traverse(TreeTraverse order,
-                                 void (*func)(const DataType&, uint32_t)) const {
-    switch (order) {
-    case IN_ORDER:
-        inOrder(func, root, 0);
-        break;
-    case PRE_ORDER:
-        preOrder(func, root, 0);
-        break;
-    case POST_ORDER:
-        postOrder(func, root, 0);
-        break;
+template<class Iter>
+void BinTree<DataType>::build(Iter first, Iter last) {
+    std::vector<const DataType*> items;
+    for (; first != last; ++first)
+    {
+        if (items.empty() || *items.back() < *first)
+            items.push_back(&*first);
     }
+    buildFrom(items);
 }
 
+/**@brief adds many items at once, in any order
+   @param first an iterator to the first item to add
+   @param last an iterator to the position after the last item
+
+The batch is sorted first. A batch that is large compared to the tree is
+merged with it and the tree is rebuilt, in O(n + m) (see mergeBuild()).
+Otherwise the items are inserted in ascending order: each insert follows
+almost the same path as the one before, so the top of that path is already
+in the cache instead of being fetched again for every item.
+*/
 template<class DataType>
-void BinTree<DataType>::erase() {
-    delNode(root);
-    root = NULL;
+template<class Iter>
+void BinTree<DataType>::insertBatch(Iter first, Iter last) {
+    std::vector<const DataType*> sorted;
+    for (; first != last; ++first)
+        sorted.push_back(&*first);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const DataType* a, const DataType* b) { return *a < *b; });
+
+    mergeBuild(*this, sorted);
 }
 
-///////////////////////////////////////////////////////////////////////////////
-//COPY
+/**@brief searches for many keys at once
+   @param first an iterator to the first key (random access)
+   @param last an iterator to the position after the last key
+   @param results where to write one iterator per key, in the same order as
+          the keys: the item that was found, or end() (random access)
+
+A single search spends most of its time waiting for the next node to arrive
+from memory, since it can not know where to go until the node is there.
+Here batchLanes searches run side by side: each step moves every search down
+one level and prefetches its next node, then moves on to the next search
+while that node is being fetched. By the time a search gets its turn again,
+its node has usually arrived. A search that finishes hands its lane to the
+next key right away, so the lanes stay full (asynchronous memory access
+chaining).
+
+The keys are visited in sorted order, so searches running side by side go
+down mostly the same paths, and those nodes are shared in the cache.
+
+~~~~~{.cc}
+vector<int> keys = {8, 3, 5};
+vector<BinTree<int>::iterator> found(keys.size());
+tree.searchBatch(keys.begin(), keys.end(), found.begin());
+~~~~~
+*/
 template<class DataType>
-BinTree<DataType>::BinTree(const BinTree<DataType>& source) {
+template<class Iter, class OutIter>
+void BinTree<DataType>::searchBatch(Iter first, Iter last,
+                                    OutIter results) const {
+    const size_t count = last - first;
+    std::vector<uint32_t> order(count);
+    for (size_t i = 0; i < count; i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&first](uint32_t a, uint32_t b) {
+        return first[a] < first[b];
+    });
+
+    struct Lane {
+        Node<DataType>* n; ///< the next node to compare with
+        uint32_t key;      ///< the index of the key being searched for
+    };
+    Lane lanes[batchLanes];
+    size_t next = 0; //the next key in order to start
+    uint32_t active = 0;
+    uint64_t compared = 0;
+    for (; active < batchLanes && next < count; active++)
+        lanes[active] = Lane{root, order[next++]};
+
+    while (active > 0)
+    {
+        for (uint32_t l = 0; l < active; l++)
+        {
+            Lane& lane = lanes[l];
+            Node<DataType>* n = lane.n;
+            bool done = (n == NULL);
+            if (!done)
+            {
+                compared++;
+                if (first[lane.key] < n->data)
+                    n = n->left;
+                else if (n->data < first[lane.key])
+                    n = n->right;
+                else
+                    done = true;
+            }
+
+            if (!done)
+            {
+                __builtin_prefetch(n);
+                lane.n = n;
+                continue;
+            }
+            results[lane.key] = iterator(n, this);
+            if (next < count) //start the next key in this lane
+            {
+                lane = Lane{root, order[next++]};
+                continue;
+            }
+            lanes[l--] = lanes[--active]; //no keys left, close the lane
+        }
+    }
+    BINTREE_COUNT(compareCount, compared);
+}
+
+/**@brief erases the contents of the tree
+
+If DataType has a trivial destructor (int, double, plain structs...), there is
+nothing to do for each node, so the node slabs are handed back all at once
+without walking the tree. Otherwise every node is destroyed first.
+*/
+template<class DataType>
+void BinTree<DataType>::erase() {
+    if (!std::is_trivially_destructible<DataType>::value)
+        delNode(root);
+    pool.release();
     root = NULL;
     nodeCount = 0;
-    source.preOrder(source.root, *this);
+    filter.clear();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//ITERATE
 template<class DataType>
-void BinTree<DataType>::operator=(const BinTree<DataType>& right) {
-    this->erase();  //erase the tree if it exists
-    right.preOrder(right.root, *this);
+typename BinTree<DataType>::iterator BinTree<DataType>::begin() const {
+    return iterator(leftmost(root), this);
 }
 
-/**@brief copies the contents from one tree to another without overwriting data
-   @param right the tree to copy from (right operand)
+template<class DataType>
+typename BinTree<DataType>::iterator BinTree<DataType>::end() const {
+    return iterator(NULL, this);
+}
 
-When called, this function copies the contents one by one in preorder. It uses
-preOrder(Node<DataType>* n, BinTree<DataType>& dest).
+/**@brief looks up data in the tree
+   @param data the data to look for
+   @return an iterator to the data, end() if it does not exist
 */
 template<class DataType>
-void BinTree<DataType>::operator+=(const BinTree<DataType>& right) {
-    right.preOrder(right.root, *this);
+template<class Key>
+typename BinTree<DataType>::iterator
+BinTree<DataType>::find(const Key& data) const {
+    BINTREE_TIME(searchTimer);
+    if (filterRejects(data))
+        return end();
+    uint32_t level;
+    return iterator(findNode(data, level), this);
 }
 
-/**@brief combines two trees
-   @param left the left operand
-   @param right the right operand
-   @return a BinTree<DataType> that contains the contents of both trees
+/**@brief finds the first item that is not less than data
+   @param data the data to compare with
+   @return an iterator to the first item >= data, end() if there is none
 */
 template<class DataType>
-BinTree<DataType> operator+(const BinTree<DataType>& left,
-                            const BinTree<DataType>& right)
-{
-    BinTree<DataType> result(left);
-    result += right;
-    return result;
+template<class Key>
+typename BinTree<DataType>::iterator
+BinTree<DataType>::lower_bound(const Key& data) const {
+    return iterator(lowerNode(data), this);
 }
 
-///////////////////////////////////////////////////////////////////////////////
-//PRIVATE
-/**@brief deletes a node and all of its children
-   @param n the node to delete
+/**@brief finds the first item that is greater than data
+   @param data the data to compare with
+   @return an iterator to the first item > data, end() if there is none
 */
 template<class DataType>
-void BinTree<DataType>::delNode(Node<DataType>* n) {
-    if (n != NULL)
-    {
-        delNode(n->left);
-        delNode(n->right);
-        delete n;
-        nodeCount--;
-    }
+template<class Key>
+typename BinTree<DataType>::iterator
+BinTree<DataType>::upper_bound(const Key& data) const {
+    return iterator(upperNode(data), this);
 }
 
-/**@brief removes the specified node from the tree
-   @param n2d the node to remove
-   @return true if the node was removed, false if it was not found
-
-Takes a double pointer as input. This is necessary so that the actual
-node within the tree (and not just a pointer to it) can be set to NULL.
-It is possible to do this using references, but because there is going to
-potentially be multiple levels of recursion, I have decided that it would be
-difficult to debug. Instead of dealing the pointers passed by reference, a
-double pointer (as in **, not double*). The memory usage should be the same,
-however, what does change is how I access the values. When using double
-pointers, you have to access the values of a node like this...
+/**@brief gets every item from low to high (including both)
+   @param low the smallest item to include
+   @param high the largest item to include
+   @return a Range that can be used in a range-based for loop
+
+Finding the ends of the range takes O(log n) in a balanced tree, and only the
+k items in the range are visited after that, for O(log n + k) in total.
 
 ~~~~~{.cc}
-Node<int>* np;
-np = new Node<int>;
-np->data = 10;
-///////////////////
-Node<int>** npp = &np;
-*npp = NULL; //sets np to be NULL (creates a memory leak here)
-np = new Node<int>;
-(*np)->data = 10; //accesses the members of np
+for (const string& name : crew.range("B", "K"))
+    cout << name << endl;
 ~~~~~
 */
 template<class DataType>
-bool BinTree<DataType>::remove(Node<DataType>** n2d) {
-    Node<DataType>* temp;
+typename BinTree<DataType>::Range
+BinTree<DataType>::range(const DataType& low, const DataType& high) const {
+    if (high < low)
+        return Range(end(), end());
+    return Range(lower_bound(low), upper_bound(high));
+}
 
-    if (n2d == NULL)
-        return false;
-    else if ((*n2d)->left == NULL && (*n2d)->right == NULL) //n2d is a leaf
-    {
-        temp = *n2d;
-        *n2d = NULL;
-    }
-    else if ((*n2d)->left == NULL) //n2d has a right subtree, no left
-    {
-        temp = *n2d;
-        *n2d = temp->right;
-    }
-    else if ((*n2d)->right == NULL) //n2d has a left subtree, no left
-    {
-        temp = *n2d;
-        *n2d = temp->left;
-    }
-    else //n2d has both a left and a right subtree
-    {
-        temp = (*n2d)->left; //move 1 node left
-        Node<DataType>* prev = NULL;
+///////////////////////////////////////////////////////////////////////////////
+//ORDER STATISTICS
+/**@brief finds the item at a position in sorted order
+   @param k the position, starting at 0 for the smallest item
+   @return an iterator to the item, end() if k >= count()
 
-        //move right as far as possible
-        while (temp->right != NULL)
+Every node keeps the size of its subtree, so the search can tell which side
+the k-th item is on without visiting that side: O(log n) in a balanced tree.
+*/
+template<class DataType>
+typename BinTree<DataType>::iterator BinTree<DataType>::select(uint32_t k) const {
+    Node<DataType>* n = root;
+
+    while (n != NULL)
+    {
+        uint32_t leftSize = sizeOf(n->left);
+        if (k < leftSize)
+            n = n->left;
+        else if (k > leftSize)
         {
-            prev = temp;
-            temp = temp->right;
+            k -= leftSize + 1;
+            n = n->right;
         }
-
-        (*n2d)->data = temp->data;
-
-        if (prev == NULL) //temp did not move
-            (*n2d)->left = temp->left;
         else
-            prev->right = temp->left;
+            break;
     }
-
-    delete temp;
-    nodeCount--;
-    return true;
+    return iterator(n, this);
 }
 
-/**@brief searches the tree recursively
-   @param data the data to look for
-   @param n the starting node
-   @param level the number of branches from root (starts at 0)
-   @return a pointer, passed by reference to the Node with the data,
-           the level of that node
-
-Disregard the level if the returned double pointer is NULL
-*/
-template<class DataType>
-const std::pair<Node<DataType>**, uint32_t>
-BinTree<DataType>::search(const DataType& data, Node<DataType>*& n,
-                          uint32_t level) const
-{    
-	if (data == n->data)
-		return std::make_pair(&n, level);
-	else if (data < n->data && n->left != NULL) //data is too big
-		search(data, n->left, level + 1);
-	else if (data > n->data && n->right != NULL) //data is too small
-		search(data, n->right, level + 1);
-	else //data does not exist
-		return std::make_pair(nullptr, level);
-    //don't know why, but it doesn't allow me to put NULL here,
-    //it seems to need nullptr
-}
-
-/**@brief traverses the tree starting at the left and working right
-@param (*func)(const DataType& data) The function to run on each node
-@param the level of each node, root = 0
-
-1. Traverse left subtree
-2. Visit node
-3. Traverse right subtree
+/**@brief counts the items that are smaller than data
+   @param data the data to compare with (does not have to be in the tree)
+   @return the number of smaller items, which is data's position if it exists
+*/
+template<class DataType>
+template<class Key>
+uint32_t BinTree<DataType>::rank(const Key& data) const {
+    return countBelow(data, false);
+}
 
-A tree set up like this (* has a value, x is NULL)...
+/**@brief counts the items from low to high (including both)
+   @param low the smallest item to count
+   @param high the largest item to count
+   @return the number of items in range(low, high), found in O(log n)
+*/
+template<class DataType>
+uint32_t BinTree<DataType>::countInRange(const DataType& low,
+                                         const DataType& high) const {
+    if (high < low)
+        return 0;
+    return countBelow(high, true) - countBelow(low, false);
+}
 
-0|     *
-||   /   \
-1|  *     *
-|| / \   / \
-2|x   *  x  *
-||   / \   / \
-3|  *   *  x  *
+///////////////////////////////////////////////////////////////////////////////
+//SET OPERATIONS
+/**@brief adds every item of other that is not already in this tree
+   @param other the tree to add (may use any balancing scheme), unchanged
+   @param threads the number of threads to use, 1 by default, 0 uses one per
+          hardware thread. Only helps when other is large.
 
-...will be traversed like this (numbers are the order in which the
-function is run).
+In a RED_BLACK tree this takes O(m*log(n/m + 1)) for m items in other: the
+tree is split around the middle item of other, each half is combined with
+the matching half of other, and the results are joined back together. A
+small other only splits and joins the few paths it touches, so adding 100
+items to a tree of millions never visits the rest of it. Every split and
+join keeps the tree balanced.
 
-0|     5
-||   /   \
-1|  1     6
-|| / \   / \
-2|x   3  x  7
-||   / \   / \
-3|  2   4  x  8
+other's items are copied into this tree's nodes first. When an item is in
+both trees, the copy already in this tree is kept, like insert() does.
+Other schemes have no height bound to lean on, so they insert or merge and
+rebuild instead (see mergeBuild()).
 */
 template<class DataType>
-void BinTree<DataType>::inOrder(void (*func)(const DataType&, uint32_t),
-                                 Node<DataType>* n, uint32_t level) {
-    if (n != NULL)
+void BinTree<DataType>::unionWith(const BinTree<DataType>& other,
+                                  unsigned threads) {
+    if (this == &other || other.root == NULL)
+        return;
+    std::vector<const DataType*> items;
+    other.flatten(items);
+    if (balance != RED_BLACK)
     {
-        inOrder(func, n->left, level + 1);
-        func(n->data, level);
-        inOrder(func, n->right, level + 1);
+        mergeBuild(*this, items);
+        return;
     }
-}
 
-/**@brief traverses the tree visiting parents, left children, and right
-children in that order
-@param (*func)(const DataType&) The function to run on each node
-@param the level of each node, root = 0
+    //allocated up front, the pool can only be used by one thread
+    std::vector<Node<DataType>*> add(items.size());
+    for (size_t i = 0; i < items.size(); i++)
+        add[i] = newNode(*items[i]);
+    std::vector<Node<DataType>*> dropped;
+    Subtree t = {root, blackHeight(root)};
+    setRoot(unionSub(t, add, 0, add.size(), dropped, forksFor(threads)),
+            dropped);
+}
 
-1. Visit node
-2. Traverse left subtree
-3. Traverse right subtree
+/**@brief removes every item that is not also in other
+   @param other the tree to compare with (any balancing scheme), unchanged
+   @param threads the number of threads to use, see unionWith()
 
-A tree set up like this (* has a value, x is NULL)...
+O(m*log(n/m + 1)) in a RED_BLACK tree, plus the time to free the items that
+are removed. Other schemes merge both trees in order and rebuild, O(n + m).
+*/
+template<class DataType>
+void BinTree<DataType>::intersectWith(const BinTree<DataType>& other,
+                                      unsigned threads) {
+    if (this == &other)
+        return;
+    std::vector<const DataType*> items;
+    other.flatten(items);
+    if (balance != RED_BLACK)
+    {
+        filterBuild(items, true);
+        return;
+    }
 
-0|     *
-||   /   \
-1|  *     *
-|| / \   / \
-2|x   *  x  *
-||   / \   / \
-3|  *   *  x  *
+    std::vector<Node<DataType>*> dropped;
+    Subtree t = {root, blackHeight(root)};
+    setRoot(filterSub(t, items, 0, items.size(), true, dropped,
+                      forksFor(threads)), dropped);
+}
 
-...will be traversed like this (numbers are the order in which the
-function is run).
+/**@brief removes every item that is also in other
+   @param other the items to remove (any balancing scheme), unchanged
+   @param threads the number of threads to use, see unionWith()
 
-0|     1
-||   /   \
-1|  2     6
-|| / \   / \
-2|x   3  x  7
-||   / \   / \
-3|  4   5  x  8
+O(m*log(n/m + 1)) in a RED_BLACK tree, O(n + m) in the others.
 */
 template<class DataType>
-void BinTree<DataType>::preOrder(void (*func)(const DataType&, uint32_t),
-                                  Node<DataType>* n, uint32_t level) {
-    if (n != NULL)
+void BinTree<DataType>::subtract(const BinTree<DataType>& other,
+                                 unsigned threads) {
+    if (this == &other)
+    {
+        erase();
+        return;
+    }
+    std::vector<const DataType*> items;
+    other.flatten(items);
+    if (balance != RED_BLACK)
     {
-        func(n->data, level);
-        preOrder(func, n->left, level + 1);
-        preOrder(func, n->right, level + 1);
+        filterBuild(items, false);
+        return;
     }
+
+    std::vector<Node<DataType>*> dropped;
+    Subtree t = {root, blackHeight(root)};
+    setRoot(filterSub(t, items, 0, items.size(), false, dropped,
+                      forksFor(threads)), dropped);
 }
 
-/**@brief traverses a tree in preorder and inserts it in another tree
-   @param n, the node to start at (used in recursion)
-   @param dest the tree to insert the copy of the data into
+/**@brief moves every item that is not less than key into a new tree
+   @param key where to cut, anything that compares with DataType using <
+   @return a tree with the same balancing scheme holding the items >= key,
+           this tree keeps the items < key
+
+A RED_BLACK tree is cut along the search path for key and each side is
+joined back into a balanced tree, in O(log n). The nodes of both sides are
+still in this tree's pool though, so the smaller side is then copied into
+the other tree's pool (O(log n + k) for k items on the smaller side).
+Other schemes copy both sides and rebuild them, O(n). If this tree has a
+filter, the new tree gets one too, filled from scratch. So does this tree
+when the nodes it keeps end up coming from the new tree's pool.
 */
 template<class DataType>
-void BinTree<DataType>::preOrder(Node<DataType>* n, BinTree<DataType>& dest) {
-    
-    if (n != NULL)
+template<class Key>
+BinTree<DataType> BinTree<DataType>::split(const Key& key) {
+    BinTree<DataType> greater(balance);
+    if (balance != RED_BLACK)
+    {
+        std::vector<const DataType*> items;
+        flatten(items);
+        size_t cut = std::lower_bound(items.begin(), items.end(), key,
+            [](const DataType* a, const Key& k) { return *a < k; }) -
+            items.begin();
+        greater.buildFrom(std::vector<const DataType*>(items.begin() + cut,
+                                                       items.end()));
+        items.resize(cut);
+        buildFrom(items);
+        if (filter.enabled())
+            greater.fillFilter(filter.falsePositiveRate());
+        return greater;
+    }
+
+    Subtree l, r;
+    Node<DataType>* m = splitSub(Subtree{root, blackHeight(root)}, key, l, r);
+    if (m != NULL)
+        r = joinSub(Subtree(), m, r);
+    if (sizeOf(r.root) <= sizeOf(l.root))
+    {
+        greater.setRoot(Subtree{greater.clone(r.root), 0}, {});
+        setRoot(l, {r.root});
+    }
+    else //keep the big side in this pool, and swap the pools afterwards
     {
-        dest.insert(n->data);
-        preOrder(n->left, dest);
-        preOrder(n->right, dest);
+        greater.setRoot(Subtree{greater.clone(l.root), 0}, {});
+        setRoot(r, {l.root});
+        swapContents(greater);
+        //setRoot() may have refilled the filter from the items >= key
+        if (filter.enabled())
+            fillFilter(filter.falsePositiveRate());
     }
+    //otherwise the filter holds every item this tree had (or was refilled
+    //from the items it kept), which is enough
+    if (filter.enabled())
+        greater.fillFilter(filter.falsePositiveRate());
+    return greater;
 }
 
-/**@brief traverses the tree visiting left children, right
-children, and parents in that order
-@param (*func)(const DataType&) The function to run on each node
-@param the level of each node, root = 0
+/**@brief adds key and then every item of right, all greater than this tree
+   @param key an item greater than everything in this tree, and less than
+          everything in right
+   @param right the tree to take the items from, it is left empty
+   @return false if the items are not in that order, nothing changes then
+
+The result depends on the balancing schemes:
+- Both RED_BLACK: the smaller tree is copied into the bigger tree's pool,
+  and the shorter tree is hung from the edge of the taller one at the level
+  where their black heights match, under a new node for key, then recolored
+  and rotated the way insert() does. O(log n + k) for k items in the smaller
+  tree, whichever side it is on.
+- Both the same other scheme (UNBALANCED, SPLAY or SEMI_SPLAY): the smaller
+  tree is copied into the bigger tree's pool, and a new node for key becomes
+  the root, with this tree on its left and right on its right. Nothing is
+  rebuilt, so the result is one level taller than the taller of the two.
+  O(k) for k items in the smaller tree.
+- Different schemes: every item is merged and the tree is rebuilt perfectly
+  balanced with this tree's scheme, O(n + k).
 
-1. Traverse left subtree
-2. Traverse right subtree
-3. Visit node
+This tree's filter (if it has one) is refilled from scratch when the nodes
+end up coming from right's pool.
+*/
+template<class DataType>
+bool BinTree<DataType>::join(const DataType& key, BinTree<DataType>& right) {
+    if (this == &right ||
+        (root != NULL && !(rightmost(root)->data < key)) ||
+        (right.root != NULL && !(key < leftmost(right.root)->data)))
+        return false;
+    if (balance != right.balance)
+    {
+        std::vector<const DataType*> items;
+        flatten(items);
+        items.push_back(&key);
+        right.flatten(items);
+        buildFrom(items);
+        right.erase();
+        return true;
+    }
 
-xA tree set up like this (* has a value, x is NULL)...
+    BinTree<DataType>& big = (right.nodeCount > nodeCount) ? right : *this;
+    BinTree<DataType>& small = (&big == this) ? right : *this;
+    Subtree copy = {big.clone(small.root), 0};
+    copy.blackHeight = blackHeight(copy.root);
+    small.erase();
 
-0|     *
-||   /   \
-1|  *   *
-|| / \   / \
-2|x   *  x  *
-||   / \   / \
-3|  *   *  x  *
+    Subtree whole = {big.root, blackHeight(big.root)};
+    Node<DataType>* m = big.newNode(key);
+    if (&big == this)
+        setRoot(joinSub(whole, m, copy), {});
+    else
+    {
+        right.setRoot(right.joinSub(copy, m, whole), {});
+        swapContents(right);
+        if (filter.enabled()) //it only knows this tree's old items
+            fillFilter(filter.falsePositiveRate());
+    }
+    return true;
+}
 
-...will be traversed like this (numbers are the order in which the
-function is run).
+///////////////////////////////////////////////////////////////////////////////
+//PARALLEL
+/**@brief runs a function on every node, spread over several threads
+   @param visit called as visit(const DataType& data, uint32_t level) once for
+          each node, from several threads at the same time, so it must be
+          thread safe. The order of the calls is not defined.
+   @param threads the number of threads to use, including the calling
+          thread. 0 uses one per hardware thread.
 
-0|     5
-||   /   \
-1|   4    8
-|| / \   / \
-2|x   3  x  7
-||   / \   / \
-3|  1   2  x  6
+Meant for expensive work on each node (checking, converting...). The top
+few levels are visited by the calling thread, and the subtrees below them
+are handed out to the threads one at a time. There are several subtrees per
+thread, so a thread that gets small subtrees just takes more of them.
+The tree must not change until parallelTraverse() returns.
 */
 template<class DataType>
-void BinTree<DataType>::postOrder(void (*func)(const DataType&, uint32_t),
-                                  Node<DataType>* n, uint32_t level) {
-    if (n != NULL)
+template<class Visit>
+void BinTree<DataType>::parallelTraverse(Visit visit,
+                                         unsigned threads) const {
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads <= 1)
     {
-        postOrder(func, n->left, level + 1);
-        postOrder(func, n->right, level + 1);
-        func(n->data, level);
+        traverse(PRE_ORDER, visit);
+        return;
+    }
+
+    std::vector<Node<DataType>*> tasks;
+    std::vector<std::pair<Node<DataType>*, uint32_t> > above;
+    uint32_t taskLevel = splitTasks(4 * threads, tasks, above);
+    for (const std::pair<Node<DataType>*, uint32_t>& a : above)
+        visit(static_cast<const DataType&>(a.first->data), a.second);
+
+    runTasks(tasks.size(), threads, [&](size_t i) {
+        walk(PRE_ORDER, tasks[i], [&](Node<DataType>* n, uint32_t level) {
+            visit(static_cast<const DataType&>(n->data), taskLevel + level);
+        });
+    });
+}
+
+/**@brief combines a value from every node, spread over several threads
+   @param identity the starting value, which combine() must leave unchanged
+          (0 for a sum, true for "all nodes pass"...)
+   @param map called as map(const DataType& data, uint32_t level) for each
+          node, from several threads at the same time
+   @param combine called as combine(Result, Result) to merge two results,
+          the order of the merges is not defined
+   @param threads the number of threads to use, see parallelTraverse()
+   @return every map() result combined
+
+Each thread combines its own subtrees, so combine() needs no locking, and
+the per-subtree results are combined at the end.
+
+~~~~~{.cc}
+//total length of all the strings
+size_t length = tree.parallelReduce(size_t(0),
+    [](const string& s, uint32_t) { return s.size(); },
+    [](size_t a, size_t b) { return a + b; });
+~~~~~
+*/
+template<class DataType>
+template<class Result, class Map, class Combine>
+Result BinTree<DataType>::parallelReduce(Result identity, Map map,
+                                         Combine combine,
+                                         unsigned threads) const {
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    std::vector<Node<DataType>*> tasks;
+    std::vector<std::pair<Node<DataType>*, uint32_t> > above;
+    uint32_t taskLevel = 0;
+    if (threads <= 1)
+        tasks.push_back(root);
+    else
+        taskLevel = splitTasks(4 * threads, tasks, above);
+
+    Result result = identity;
+    for (const std::pair<Node<DataType>*, uint32_t>& a : above)
+        result = combine(result, map(static_cast<const DataType&>(
+                                         a.first->data), a.second));
+
+    std::vector<Result> partial(tasks.size(), identity);
+    runTasks(tasks.size(), threads, [&](size_t i) {
+        Result sub = identity;
+        walk(PRE_ORDER, tasks[i], [&](Node<DataType>* n, uint32_t level) {
+            sub = combine(sub, map(static_cast<const DataType&>(n->data),
+                                   taskLevel + level));
+        });
+        partial[i] = sub;
+    });
+
+    for (const Result& sub : partial)
+        result = combine(result, sub);
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//FILTER
+/**@brief keeps a Bloom filter of the items, so most misses skip the search
+   @param falsePositiveRate the share of misses that still search the tree,
+          between 0 and 1 (1% by default)
+
+Only for data that std::hash can hash (the function does not exist for
+other types). The filter is a BloomFilter sized for twice the current count
+and filled right away, O(n). From then on:
+* search(), find() and remove() check it first when called with a DataType.
+  A miss then usually costs one cache line instead of a walk down the tree.
+  Lookups with another key type (see search()) skip the filter, since their
+  hash would not match.
+* Every new node is added to it, and when the count outgrows it, it is
+  rebuilt twice as big
+* Bits can not be removed, so removed items keep answering "maybe" and make
+  the filter less effective. Once half of what it holds has been removed,
+  the insert or remove that notices rebuilds it, O(n). That happens at most
+  once per n/2 changes, so it adds O(1) per change on average. (There is no
+  background rebuild, so a tree never runs threads of its own.)
+
+Calling it again resizes the filter for the new rate.
+
+~~~~~{.cc}
+BinTree<uint64_t> ids(RED_BLACK);
+ids.enableFilter(0.01);
+ids.search(42); //false, usually without reading a single node
+~~~~~
+*/
+template<class DataType>
+template<class T, class>
+void BinTree<DataType>::enableFilter(double falsePositiveRate) {
+    fillFilter(falsePositiveRate);
+}
+
+template<class DataType>
+void BinTree<DataType>::disableFilter() {
+    filter.release();
+}
+
+template<class DataType>
+size_t BinTree<DataType>::filterMemory() const {
+    return filter.memory();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//STATS
+/**@brief measures the shape of the tree and collects its counters
+   @return see TreeStats, toJson() gives it in a form monitoring can read
+
+The shape takes one walk over the tree (O(n), no recursion), so call this
+every few seconds rather than after every insert. Reading the counters is
+O(1) and has no effect on them.
+
+Comparisons are counted once per node a search is compared against. insert
+(and emplace) always counts them. The lookups (search, find, remove,
+lower_bound, upper_bound and searchBatch) and the filter's misses are only
+counted when BINTREE_STATS is defined, since a counter written on every
+lookup is a cache line that readers on several threads fight over.
+Allocations and rotations are always counted.
+
+Define BINTREE_STATS before including BinTree.hh to count those, and to time
+every call to insert (and emplace), search (and find) and remove. It is off
+by default, since reading the clock can cost as much as a search in a small
+tree.
+
+~~~~~{.cc}
+TreeStats s = tree.stats();
+if (s.height > 2 * s.optimalHeight) //more than RED_BLACK ever allows
+    alert(s.toJson());
+~~~~~
+*/
+template<class DataType>
+TreeStats BinTree<DataType>::stats() const {
+    TreeStats s;
+    s.count = nodeCount;
+    uint64_t pathTotal = 0;
+    walk(PRE_ORDER, root, [&s, &pathTotal](Node<DataType>*, uint32_t level) {
+        if (level == s.depths.size()) //preorder goes down 1 level at a time
+            s.depths.push_back(0);
+        s.depths[level]++;
+        pathTotal += level + 1;
+    });
+    s.height = s.depths.size();
+    while ((static_cast<uint64_t>(1) << s.optimalHeight) - 1 < nodeCount)
+        s.optimalHeight++;
+    if (nodeCount > 0)
+        s.averagePath = static_cast<double>(pathTotal) / nodeCount;
+
+    s.comparisons = compareCount.get();
+    s.allocations = allocCount.get();
+    s.rotations = rotateCount.get();
+    s.filtered = filterCount.get();
+    s.filterBytes = filter.memory();
+#ifdef BINTREE_STATS
+    s.insert = insertTimer.get();
+    s.search = searchTimer.get();
+    s.remove = removeTimer.get();
+#endif
+    return s;
+}
+
+template<class DataType>
+void BinTree<DataType>::resetStats() {
+    compareCount.reset();
+    allocCount.reset();
+    rotateCount.reset();
+    filterCount.reset();
+#ifdef BINTREE_STATS
+    insertTimer.reset();
+    searchTimer.reset();
+    removeTimer.reset();
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//SNAPSHOT
+/**@brief makes a read-only copy of the tree that is faster to search
+   @return a FrozenBinTree holding every item, in one array with no pointers
+
+The snapshot does not change when the tree does. Use it for data that is
+built once and then searched many times, possibly by many threads at once.
+*/
+template<class DataType>
+FrozenBinTree<DataType> BinTree<DataType>::freeze() const {
+    return FrozenBinTree<DataType>(begin(), end());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//COPY
+/**@brief copy constructor, the copy uses the same balancing scheme
+
+The copy has exactly the same shape as source, and a copy of its filter (if
+it has one, see enableFilter()). Nodes are cloned one by one
+without comparing any data, so this takes O(n) no matter how the tree is
+shaped.
+*/
+template<class DataType>
+BinTree<DataType>::BinTree(const BinTree<DataType>& source) {
+    balance = source.balance;
+    root = clone(source.root);
+    nodeCount = source.nodeCount;
+    filter = source.filter;
+}
+
+/**@brief move constructor, takes over source's nodes without copying them
+   @param source the tree to take from, it is left empty
+*/
+template<class DataType>
+BinTree<DataType>::BinTree(BinTree<DataType>&& source) {
+    balance = source.balance;
+    root = NULL;
+    nodeCount = 0;
+    swapContents(source);
+    std::swap(filter, source.filter);
+}
+
+/**@brief overwrites the contents, keeps this tree's balancing scheme (and
+          filter setting)
+
+If both trees use the same balancing scheme, right is cloned (see the copy
+constructor). Otherwise its shape might not be valid here, so the tree is
+rebuilt balanced from right's data instead. Either way it takes O(n).
+*/
+template<class DataType>
+BinTree<DataType>&
+BinTree<DataType>::operator=(const BinTree<DataType>& right) {
+    if (this == &right)
+        return *this;
+    this->erase();  //erase the tree if it exists
+    if (balance == right.balance)
+    {
+        root = clone(right.root);
+        nodeCount = right.nodeCount;
+    }
+    else
+        build(right.begin(), right.end());
+    return *this;
+}
+
+/**@brief overwrites the contents by taking over right's nodes
+   @param right the tree to take from, it is left empty
+
+The balancing scheme comes along with the nodes, since their shape (and
+colors) only make sense under the scheme they were built with. So does the
+filter (see enableFilter()).
+*/
+template<class DataType>
+BinTree<DataType>& BinTree<DataType>::operator=(BinTree<DataType>&& right) {
+    if (this == &right)
+        return *this;
+    erase();
+    balance = right.balance;
+    swapContents(right);
+    std::swap(filter, right.filter);
+    return *this;
+}
+
+/**@brief copies the contents from one tree to another without overwriting data
+   @param right the tree to copy from (right operand)
+
+The same as unionWith(right). A RED_BLACK tree splits and joins along the
+paths right's items land on, for O(m*log(n/m + 1)). In the other schemes,
+when right is small, its data is inserted one item at a time, for
+O(m*log(n + m)). Otherwise both trees are merged in order and the result is
+rebuilt perfectly balanced, for O(n + m). See mergeBuild().
+*/
+template<class DataType>
+void BinTree<DataType>::operator+=(const BinTree<DataType>& right) {
+    unionWith(right);
+}
+
+/**@brief combines two trees
+   @param left the left operand
+   @param right the right operand
+   @return a BinTree<DataType> that contains the contents of both trees,
+           built perfectly balanced in O(n + m) with left's balancing scheme
+*/
+template<class DataType>
+BinTree<DataType> operator+(const BinTree<DataType>& left,
+                            const BinTree<DataType>& right)
+{
+    BinTree<DataType> result(left.balance);
+    std::vector<const DataType*> items;
+    right.flatten(items);
+    result.mergeBuild(left, items);
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+/**@brief allocates a node from the pool and builds its data in place
+   @param args the arguments for DataType's constructor (often just a
+          DataType to copy or move)
+   @return the new node, with no links and colored black
+*/
+template<class DataType>
+template<class... Args>
+Node<DataType>* BinTree<DataType>::newNode(Args&&... args) {
+    allocCount.add(1);
+    Node<DataType>* n =
+        new (pool.allocate()) Node<DataType>(std::forward<Args>(args)...);
+    filterAdd(n->data);
+    return n;
+}
+
+///@brief destroys a node and returns its memory to the pool
+template<class DataType>
+void BinTree<DataType>::freeNode(Node<DataType>* n) {
+    n->~Node<DataType>();
+    pool.deallocate(n);
+}
+
+/**@brief allocates a node from the pool that copies another node
+   @param n the node to copy the data, color, and size of
+   @return the new node, with no links
+*/
+template<class DataType>
+Node<DataType>* BinTree<DataType>::cloneNode(const Node<DataType>* n) {
+    Node<DataType>* c = newNode(n->data);
+    c->red = n->red;
+    c->size = n->size;
+    return c;
+}
+
+///@brief trades contents (nodes, count, and the pool that holds them)
+template<class DataType>
+void BinTree<DataType>::swapContents(BinTree<DataType>& other) {
+    std::swap(root, other.root);
+    std::swap(nodeCount, other.nodeCount);
+    pool.swap(other.pool);
+}
+
+/**@brief copies a subtree node for node, keeping its exact shape
+   @param n the root of the subtree to copy (may be from another tree)
+   @return the root of the copy, its parent is NULL
+
+Walks the source in preorder without recursion, moving the source and copy
+positions together. Children are created the first time a node is reached
+from above, so a child that is not NULL in the source but NULL in the copy
+has not been visited yet.
+*/
+template<class DataType>
+Node<DataType>* BinTree<DataType>::clone(const Node<DataType>* n) {
+    if (n == NULL)
+        return NULL;
+
+    Node<DataType>* const top = cloneNode(n);
+    const Node<DataType>* src = n;
+    Node<DataType>* dest = top;
+
+    while (true)
+    {
+        if (src->left != NULL && dest->left == NULL)
+        {
+            dest->left = cloneNode(src->left);
+            dest->left->parent = dest;
+            src = src->left;
+            dest = dest->left;
+        }
+        else if (src->right != NULL && dest->right == NULL)
+        {
+            dest->right = cloneNode(src->right);
+            dest->right->parent = dest;
+            src = src->right;
+            dest = dest->right;
+        }
+        else if (src == n)
+            return top;
+        else
+        {
+            src = src->parent;
+            dest = dest->parent;
+        }
+    }
+}
+
+/**@brief replaces the contents of the tree with a perfectly balanced tree
+   @param items pointers to the data, in ascending order with no duplicates
+
+The new tree is built in a separate pool and swapped in, so items may point
+into this tree.
+*/
+template<class DataType>
+void BinTree<DataType>::buildFrom(const std::vector<const DataType*>& items) {
+    //the number of completely full levels in the new tree
+    uint32_t fullLevels = 0;
+    while ((static_cast<uint64_t>(2) << fullLevels) - 1 <= items.size())
+        fullLevels++;
+
+    BinTree<DataType> result(balance);
+    result.root = result.buildRange(items, 0, items.size(), 0, fullLevels);
+    result.nodeCount = items.size();
+    swapContents(result);
+    allocCount.add(items.size()); //counted in result, which is thrown away
+    if (filter.enabled()) //result had no filter
+        fillFilter(filter.falsePositiveRate());
+}
+
+/**@brief builds a perfectly balanced subtree out of part of a sorted list
+   @param items pointers to the data, in ascending order with no duplicates
+   @param first the index of the first item in the subtree
+   @param last the index after the last item in the subtree
+   @param level the level the subtree's root will be on
+   @param redLevel the level to color red in a RED_BLACK tree
+   @return the root of the subtree, its parent is NULL
+
+The middle item becomes the root, and the halves on either side become its
+subtrees. The sides never differ in size by more than 1, so every level is
+full except for the bottom one (redLevel). Coloring the bottom level red and
+the rest black gives every path the same number of black nodes, which makes
+it a valid red-black tree without any rotations. The recursion is only
+lg(n) deep.
+*/
+template<class DataType>
+Node<DataType>* BinTree<DataType>::buildRange(
+    const std::vector<const DataType*>& items, size_t first, size_t last,
+    uint32_t level, uint32_t redLevel)
+{
+    if (first >= last)
+        return NULL;
+
+    const size_t mid = first + (last - first) / 2;
+    Node<DataType>* n = newNode(*items[mid]);
+    n->size = last - first;
+    n->red = (balance == RED_BLACK && level == redLevel);
+
+    n->left = buildRange(items, first, mid, level + 1, redLevel);
+    if (n->left != NULL)
+        n->left->parent = n;
+    n->right = buildRange(items, mid + 1, last, level + 1, redLevel);
+    if (n->right != NULL)
+        n->right->parent = n;
+    return n;
+}
+
+///@brief adds pointers to the data in the tree to items, in order
+template<class DataType>
+void BinTree<DataType>::flatten(std::vector<const DataType*>& items) const {
+    items.reserve(items.size() + nodeCount);
+    for (const DataType& data : *this)
+        items.push_back(&data);
+}
+
+/**@brief replaces the contents of the tree with the union of a and b
+   @param a a tree, may be this tree
+   @param b pointers to more data, in ascending order (duplicates are fine)
+
+If this tree is a and b is small compared to it, b is inserted one item at a
+time (O(m*log(n + m)) beats a rebuild). Otherwise the two are merged like in
+merge sort and rebuilt perfectly balanced, in O(n + m).
+*/
+template<class DataType>
+void BinTree<DataType>::mergeBuild(const BinTree<DataType>& a,
+                                   const std::vector<const DataType*>& b) {
+    const size_t n = a.nodeCount;
+    const size_t m = b.size();
+
+    if (&a == this)
+    {
+        uint32_t lg = 1;
+        while ((static_cast<size_t>(1) << lg) < n + m)
+            lg++;
+        if (m * lg < n)
+        {
+            for (const DataType* data : b)
+                insert(*data);
+            return;
+        }
+    }
+
+    std::vector<const DataType*> items;
+    items.reserve(n + m);
+    iterator ai = a.begin();
+    size_t bi = 0;
+    while (ai != a.end() || bi < m)
+    {
+        const DataType* next;
+        if (bi == m || (ai != a.end() && *ai < *b[bi]))
+            next = &*ai++;
+        else
+            next = b[bi++];
+        if (items.empty() || *items.back() < *next)
+            items.push_back(next);
+    }
+    buildFrom(items);
+}
+
+/**@brief deletes a node and all of its children
+   @param n the node to delete
+
+Works its way down to a leaf, deletes it, then climbs back up to the parent
+using the parent pointer. No recursion is used, so the depth of the tree does
+not matter. The link from n's parent to n is not cleared.
+*/
+template<class DataType>
+void BinTree<DataType>::delNode(Node<DataType>* n) {
+    Node<DataType>* stop = (n == NULL) ? NULL : n->parent;
+
+    while (n != stop)
+    {
+        if (n->left != NULL)
+            n = n->left;
+        else if (n->right != NULL)
+            n = n->right;
+        else
+        {
+            Node<DataType>* parent = n->parent;
+            if (parent != stop)
+            {
+                if (parent->left == n)
+                    parent->left = NULL;
+                else
+                    parent->right = NULL;
+            }
+            freeNode(n);
+            nodeCount--;
+            n = parent;
+        }
+    }
+}
+
+/**@brief removes the specified node from the tree
+   @param n2d the node to remove (must be in the tree)
+
+If n2d has two children, it is replaced by the rightmost node of its left
+subtree (its in-order predecessor). Nodes are relinked rather than having
+their data copied, so no other node is moved in memory.
+
+In a RED_BLACK tree, removing a black node leaves one path short of a black
+node, which is repaired by removeFixup(). A SPLAY tree moves the node above
+the removed spot up to root.
+*/
+template<class DataType>
+void BinTree<DataType>::remove(Node<DataType>* n2d) {
+    Node<DataType>* child;       //the node that moves into the removed spot
+    Node<DataType>* childParent; //child's new parent (child may be NULL)
+    bool removedRed = n2d->red;
+
+    if (n2d->left == NULL) //n2d has a right subtree or nothing
+    {
+        child = n2d->right;
+        childParent = n2d->parent;
+        transplant(n2d, n2d->right);
+    }
+    else if (n2d->right == NULL) //n2d has a left subtree, no right
+    {
+        child = n2d->left;
+        childParent = n2d->parent;
+        transplant(n2d, n2d->left);
+    }
+    else //n2d has both a left and a right subtree
+    {
+        //move 1 node left, then right as far as possible
+        Node<DataType>* temp = n2d->left;
+        while (temp->right != NULL)
+            temp = temp->right;
+
+        removedRed = temp->red;
+        child = temp->left;
+        if (temp->parent == n2d) //temp did not move
+            childParent = temp;
+        else
+        {
+            childParent = temp->parent;
+            transplant(temp, temp->left);
+            temp->left = n2d->left;
+            temp->left->parent = temp;
+        }
+        transplant(n2d, temp);
+        temp->right = n2d->right;
+        temp->right->parent = temp;
+        temp->red = n2d->red;
+        temp->size = n2d->size;
+    }
+
+    //every subtree from the removed spot up to root is now 1 node smaller
+    for (Node<DataType>* p = childParent; p != NULL; p = p->parent)
+        p->size--;
+
+    freeNode(n2d);
+    nodeCount--;
+
+    if (balance == RED_BLACK && !removedRed)
+        removeFixup(child, childParent);
+    else
+        splay(childParent);
+    checkFilter();
+}
+
+/**@brief puts child in the place of n, as far as n's parent is concerned
+   @param n the node to replace
+   @param child the node to move in (may be NULL)
+
+n's own links are left alone.
+*/
+template<class DataType>
+void BinTree<DataType>::transplant(Node<DataType>* n, Node<DataType>* child) {
+    if (n->parent == NULL)
+        root = child;
+    else if (n->parent->left == n)
+        n->parent->left = child;
+    else
+        n->parent->right = child;
+
+    if (child != NULL)
+        child->parent = n->parent;
+}
+
+/**@brief rotates n down to the left, its right child takes its place
+
+    n               r
+   / \             / \
+  a   r    ->     n   c
+     / \         / \
+    b   c        a   b
+*/
+template<class DataType>
+void BinTree<DataType>::rotateLeft(Node<DataType>* n) {
+    Node<DataType>* r = n->right;
+    n->right = r->left;
+    if (r->left != NULL)
+        r->left->parent = n;
+    transplant(n, r);
+    r->left = n;
+    n->parent = r;
+    rotateCount.add(1);
+
+    r->size = n->size;
+    n->size = 1 + sizeOf(n->left) + sizeOf(n->right);
+}
+
+///@brief rotates n down to the right, the mirror image of rotateLeft()
+template<class DataType>
+void BinTree<DataType>::rotateRight(Node<DataType>* n) {
+    Node<DataType>* l = n->left;
+    n->left = l->right;
+    if (l->right != NULL)
+        l->right->parent = n;
+    transplant(n, l);
+    l->right = n;
+    n->parent = l;
+    rotateCount.add(1);
+
+    l->size = n->size;
+    n->size = 1 + sizeOf(n->left) + sizeOf(n->right);
+}
+
+///@brief rotates n up into its parent's place (n must have a parent)
+template<class DataType>
+void BinTree<DataType>::rotateUp(Node<DataType>* n) {
+    if (n == n->parent->left)
+        rotateRight(n->parent);
+    else
+        rotateLeft(n->parent);
+}
+
+/**@brief moves a node up a SPLAY or SEMI_SPLAY tree
+   @param n the node that was just used (may be NULL)
+
+Does nothing for other balancing schemes. The node climbs 2 levels at a
+time. When n and its parent are on the same side (zig-zig), the parent is
+rotated first and then n, which roughly halves the depth of every node on
+the path, not just n's. When they are on opposite sides (zig-zag), n is
+rotated twice. A single rotation finishes the climb when n is 1 level
+below root.
+
+SEMI_SPLAY stops halfway through each zig-zig: the parent is rotated up,
+and the climb goes on from the parent instead of n. n ends up about half
+way to root, with about half as many rotations.
+
+          g             p                   n
+         / \           / \                 / \
+        p   d   ->    n   g   (SPLAY) ->  a   p
+       / \           / \ / \                 / \
+      n   c         a  b c  d               b   g
+     / \                                       / \
+    a   b            (SEMI_SPLAY stops,        c   d
+                      goes on from p)
+*/
+template<class DataType>
+void BinTree<DataType>::splay(Node<DataType>* n) {
+    if (n == NULL || (balance != SPLAY && balance != SEMI_SPLAY))
+        return;
+
+    while (n->parent != NULL)
+    {
+        Node<DataType>* parent = n->parent;
+        Node<DataType>* grand = parent->parent;
+        if (grand == NULL) //zig
+            rotateUp(n);
+        else if ((n == parent->left) == (parent == grand->left)) //zig-zig
+        {
+            rotateUp(parent);
+            if (balance == SEMI_SPLAY)
+                n = parent;
+            else
+                rotateUp(n);
+        }
+        else //zig-zag
+        {
+            rotateUp(n);
+            rotateUp(n);
+        }
+    }
+}
+
+/**@brief restores the red-black properties after a red node is inserted
+   @param n the new node
+
+The rules of a red-black tree:
+1. Every node is red or black, root is black
+2. A red node never has a red child
+3. Every path from a node down to a NULL passes the same number of black nodes
+
+A new node is red, so only rule 2 can be broken (when its parent is red).
+If the uncle is red as well, the parent and uncle turn black and the
+grandparent turns red, moving the problem 2 levels up. Otherwise, 1 or 2
+rotations fix it for good. At most 2 rotations happen per insert.
+*/
+template<class DataType>
+void BinTree<DataType>::insertFixup(Node<DataType>* n) {
+    while (n->parent != NULL && n->parent->red)
+    {
+        Node<DataType>* parent = n->parent;
+        Node<DataType>* grand = parent->parent; //exists, root is black
+
+        if (parent == grand->left)
+        {
+            Node<DataType>* uncle = grand->right;
+            if (uncle != NULL && uncle->red)
+            {
+                parent->red = false;
+                uncle->red = false;
+                grand->red = true;
+                n = grand;
+                continue;
+            }
+            if (n == parent->right)
+            {
+                rotateLeft(parent);
+                n = parent;
+                parent = n->parent;
+            }
+            parent->red = false;
+            grand->red = true;
+            rotateRight(grand);
+        }
+        else //mirror image
+        {
+            Node<DataType>* uncle = grand->left;
+            if (uncle != NULL && uncle->red)
+            {
+                parent->red = false;
+                uncle->red = false;
+                grand->red = true;
+                n = grand;
+                continue;
+            }
+            if (n == parent->left)
+            {
+                rotateRight(parent);
+                n = parent;
+                parent = n->parent;
+            }
+            parent->red = false;
+            grand->red = true;
+            rotateLeft(grand);
+        }
+    }
+    root->red = false;
+}
+
+/**@brief restores the red-black properties after a black node is removed
+   @param n the node that took the removed node's place (may be NULL)
+   @param parent n's parent, needed because n may be NULL
+
+The path through n is one black node short. If n is red, turning it black
+fixes that. Otherwise n's sibling is recolored and rotated until the missing
+black node is made up, moving up the tree if the sibling's side has to be
+shortened to match. At most 3 rotations happen per remove.
+*/
+template<class DataType>
+void BinTree<DataType>::removeFixup(Node<DataType>* n, Node<DataType>* parent) {
+    while (n != root && (n == NULL || !n->red))
+    {
+        if (n == parent->left)
+        {
+            Node<DataType>* sibling = parent->right; //never NULL here
+            if (sibling->red)
+            {
+                sibling->red = false;
+                parent->red = true;
+                rotateLeft(parent);
+                sibling = parent->right;
+            }
+            if ((sibling->left == NULL || !sibling->left->red) &&
+                (sibling->right == NULL || !sibling->right->red))
+            {
+                sibling->red = true;
+                n = parent;
+                parent = n->parent;
+                continue;
+            }
+            if (sibling->right == NULL || !sibling->right->red)
+            {
+                sibling->left->red = false;
+                sibling->red = true;
+                rotateRight(sibling);
+                sibling = parent->right;
+            }
+            sibling->red = parent->red;
+            parent->red = false;
+            sibling->right->red = false;
+            rotateLeft(parent);
+            n = root;
+        }
+        else //mirror image
+        {
+            Node<DataType>* sibling = parent->left;
+            if (sibling->red)
+            {
+                sibling->red = false;
+                parent->red = true;
+                rotateRight(parent);
+                sibling = parent->left;
+            }
+            if ((sibling->left == NULL || !sibling->left->red) &&
+                (sibling->right == NULL || !sibling->right->red))
+            {
+                sibling->red = true;
+                n = parent;
+                parent = n->parent;
+                continue;
+            }
+            if (sibling->left == NULL || !sibling->left->red)
+            {
+                sibling->right->red = false;
+                sibling->red = true;
+                rotateLeft(sibling);
+                sibling = parent->left;
+            }
+            sibling->red = parent->red;
+            parent->red = false;
+            sibling->left->red = false;
+            rotateRight(parent);
+            n = root;
+        }
+    }
+    if (n != NULL)
+        n->red = false;
+}
+
+///@brief true if n is a red node, NULL counts as black
+template<class DataType>
+bool BinTree<DataType>::isRed(const Node<DataType>* n) {
+    return n != NULL && n->red;
+}
+
+/**@brief counts the black nodes on the way down from n (including n)
+   @return the black height, which is the same on every path in a RED_BLACK
+           tree, so following the left edge is enough: O(log n)
+*/
+template<class DataType>
+uint32_t BinTree<DataType>::blackHeight(const Node<DataType>* n) {
+    uint32_t height = 0;
+    for (; n != NULL; n = n->left)
+        height += !n->red;
+    return height;
+}
+
+/**@brief makes l and r the children of m
+   @param red the color to give m
+   @return m, with its size updated (its parent is left alone)
+*/
+template<class DataType>
+Node<DataType>* BinTree<DataType>::link(Node<DataType>* l, Node<DataType>* m,
+                                        Node<DataType>* r, bool red) {
+    m->left = l;
+    m->right = r;
+    if (l != NULL)
+        l->parent = m;
+    if (r != NULL)
+        r->parent = m;
+    m->red = red;
+    m->size = 1 + sizeOf(l) + sizeOf(r);
+    return m;
+}
+
+/**@brief joins a shorter subtree r to the right edge of l, through m
+   @param l the taller subtree (or the same black height), every item < m
+   @param lHeight l's black height
+   @param m the node to join them with
+   @param r the shorter subtree, every item > m
+   @param rHeight r's black height
+   @return the root of the joined subtree, with the same black height as l,
+           its root may be red with a red right child (see joinSub())
+
+Goes down l's right edge to the first black node with r's black height,
+and puts m (red) in its place, with that node and r as m's children. Every
+path still has the same number of black nodes. If m's parent is red too,
+the red pair is pushed up the edge by rotating, like insertFixup().
+*/
+template<class DataType>
+Node<DataType>* BinTree<DataType>::joinRight(Node<DataType>* l,
+                                             uint32_t lHeight,
+                                             Node<DataType>* m,
+                                             Node<DataType>* r,
+                                             uint32_t rHeight) {
+    if (!isRed(l) && lHeight == rHeight)
+        return link(l, m, r, true);
+
+    Node<DataType>* right = joinRight(l->right, lHeight - !l->red, m,
+                                      r, rHeight);
+    link(l->left, l, right, l->red);
+    if (!l->red && right->red && isRed(right->right))
+    {
+        //rotate left: right takes l's place, l becomes its left child
+        right->right->red = false;
+        link(l->left, l, right->left, false);
+        link(l, right, right->right, true);
+        rotateCount.add(1);
+        return right;
+    }
+    return l;
+}
+
+///@brief joins a shorter subtree l to the left edge of r, see joinRight()
+template<class DataType>
+Node<DataType>* BinTree<DataType>::joinLeft(Node<DataType>* l,
+                                            uint32_t lHeight,
+                                            Node<DataType>* m,
+                                            Node<DataType>* r,
+                                            uint32_t rHeight) {
+    if (!isRed(r) && lHeight == rHeight)
+        return link(l, m, r, true);
+
+    Node<DataType>* left = joinLeft(l, lHeight, m, r->left,
+                                    rHeight - !r->red);
+    link(left, r, r->right, r->red);
+    if (!r->red && left->red && isRed(left->left))
+    {
+        left->left->red = false;
+        link(left->right, r, r->right, false);
+        link(left->left, left, r, true);
+        rotateCount.add(1);
+        return left;
+    }
+    return r;
+}
+
+/**@brief joins two subtrees and a node between them into one subtree
+   @param l a subtree, every item < m
+   @param m the node to put between them (its links are overwritten)
+   @param r a subtree, every item > m
+   @return the joined subtree, its root's parent is NULL
+
+In a RED_BLACK tree, this takes O(difference in black height + 1). The
+result is a valid red-black tree, though its root may be red. Other
+schemes just hang l and r from m.
+*/
+template<class DataType>
+typename BinTree<DataType>::Subtree
+BinTree<DataType>::joinSub(Subtree l, Node<DataType>* m, Subtree r) {
+    Subtree t;
+    if (balance != RED_BLACK)
+        t.root = link(l.root, m, r.root, false);
+    else if (l.blackHeight > r.blackHeight)
+    {
+        t.root = joinRight(l.root, l.blackHeight, m, r.root, r.blackHeight);
+        t.blackHeight = l.blackHeight;
+        if (t.root->red && isRed(t.root->right))
+        {
+            t.root->red = false;
+            t.blackHeight++;
+        }
+    }
+    else if (l.blackHeight < r.blackHeight)
+    {
+        t.root = joinLeft(l.root, l.blackHeight, m, r.root, r.blackHeight);
+        t.blackHeight = r.blackHeight;
+        if (t.root->red && isRed(t.root->left))
+        {
+            t.root->red = false;
+            t.blackHeight++;
+        }
+    }
+    else if (!isRed(l.root) && !isRed(r.root))
+    {
+        t.root = link(l.root, m, r.root, true);
+        t.blackHeight = l.blackHeight;
+    }
+    else
+    {
+        t.root = link(l.root, m, r.root, false);
+        t.blackHeight = l.blackHeight + 1;
+    }
+    t.root->parent = NULL;
+    return t;
+}
+
+/**@brief joins two subtrees, every item in l < every item in r
+   @return the joined subtree
+
+The largest node of l is cut out with splitSub() and used to join them.
+*/
+template<class DataType>
+typename BinTree<DataType>::Subtree
+BinTree<DataType>::joinSub(Subtree l, Subtree r) {
+    if (l.root == NULL)
+        return r;
+    if (r.root == NULL)
+        return l;
+    Subtree rest, none;
+    Node<DataType>* m = splitSub(l, rightmost(l.root)->data, rest, none);
+    return joinSub(rest, m, r);
+}
+
+/**@brief cuts a subtree in two around key
+   @param t the subtree to cut, its nodes are reused
+   @param key where to cut
+   @param l set to a subtree of the items < key
+   @param r set to a subtree of the items > key
+   @return the node equal to key with its links cleared, NULL if there is
+           none
+
+Goes down the search path for key. On the way back up, each node on the
+path is joined with the part of its subtree on the same side of key. Those
+joins get taller as they go up, and their costs add up to O(log n) in
+total. The recursion is as deep as the tree, which a RED_BLACK tree keeps
+to 2*lg(n + 1).
+*/
+template<class DataType>
+template<class Key>
+Node<DataType>* BinTree<DataType>::splitSub(Subtree t, const Key& key,
+                                            Subtree& l, Subtree& r) {
+    Node<DataType>* n = t.root;
+    if (n == NULL)
+    {
+        l = r = Subtree();
+        return NULL;
+    }
+
+    const uint32_t childHeight = t.blackHeight - !n->red;
+    Subtree left = {n->left, childHeight}, right = {n->right, childHeight};
+    Node<DataType>* found;
+    if (key < n->data)
+    {
+        Subtree mid;
+        found = splitSub(left, key, l, mid);
+        r = joinSub(mid, n, right);
+    }
+    else if (n->data < key)
+    {
+        Subtree mid;
+        found = splitSub(right, key, mid, r);
+        l = joinSub(left, n, mid);
+    }
+    else
+    {
+        l = left;
+        r = right;
+        if (l.root != NULL)
+            l.root->parent = NULL;
+        if (r.root != NULL)
+            r.root->parent = NULL;
+        link(NULL, n, NULL, false);
+        n->parent = NULL;
+        found = n;
+    }
+    return found;
+}
+
+/**@brief combines a subtree with a sorted range of new nodes
+   @param t the subtree, its nodes are reused
+   @param add new nodes holding other's items, in ascending order
+   @param first the index of the first node in the range
+   @param last the index after the last node in the range
+   @param dropped gets the new nodes that turned out to be duplicates
+   @param forks how many more times the work may be split between threads
+   @return a subtree holding both
+
+t is split around the middle node of the range, the halves are combined
+with the halves of the range (on 2 threads while forks is above 0), and the
+results are joined through the middle node. Each half only touches its own
+nodes, so the threads never share any.
+*/
+template<class DataType>
+typename BinTree<DataType>::Subtree
+BinTree<DataType>::unionSub(Subtree t,
+                            const std::vector<Node<DataType>*>& add,
+                            size_t first, size_t last,
+                            std::vector<Node<DataType>*>& dropped,
+                            uint32_t forks) {
+    if (first >= last)
+        return t;
+
+    const size_t mid = first + (last - first) / 2;
+    Node<DataType>* m = add[mid];
+    Subtree l, r, lu, ru;
+    Node<DataType>* same = splitSub(t, m->data, l, r);
+    if (same != NULL) //keep the item that was already here
+    {
+        dropped.push_back(m);
+        m = same;
+    }
+
+    std::vector<Node<DataType>*> leftDropped;
+    const bool fork = forks > 0 && last - first >= forkMinimum;
+    uint32_t nextForks = (forks > 0) ? forks - 1 : 0;
+    forkJoin(fork, [&]() {
+        lu = unionSub(l, add, first, mid, leftDropped, nextForks);
+    }, [&]() {
+        ru = unionSub(r, add, mid + 1, last, dropped, nextForks);
+    });
+    dropped.insert(dropped.end(), leftDropped.begin(), leftDropped.end());
+    return joinSub(lu, m, ru);
+}
+
+/**@brief keeps (or removes) the items of a subtree that are in a range
+   @param t the subtree, its nodes are reused
+   @param items pointers to other's items, in ascending order
+   @param first the index of the first item in the range
+   @param last the index after the last item in the range
+   @param keep true to keep only the items in the range (intersection),
+          false to keep only the items that are not (difference)
+   @param dropped gets the nodes and whole subtrees that were removed
+   @param forks see unionSub()
+   @return the subtree that is left
+*/
+template<class DataType>
+typename BinTree<DataType>::Subtree
+BinTree<DataType>::filterSub(Subtree t,
+                             const std::vector<const DataType*>& items,
+                             size_t first, size_t last, bool keep,
+                             std::vector<Node<DataType>*>& dropped,
+                             uint32_t forks) {
+    if (t.root == NULL)
+        return t;
+    if (first >= last) //nothing left to match
+    {
+        if (!keep)
+            return t;
+        dropped.push_back(t.root);
+        return Subtree();
+    }
+
+    const size_t mid = first + (last - first) / 2;
+    Subtree l, r, lf, rf;
+    Node<DataType>* same = splitSub(t, *items[mid], l, r);
+
+    std::vector<Node<DataType>*> leftDropped;
+    const bool fork = forks > 0 && last - first >= forkMinimum;
+    uint32_t nextForks = (forks > 0) ? forks - 1 : 0;
+    forkJoin(fork, [&]() {
+        lf = filterSub(l, items, first, mid, keep, leftDropped, nextForks);
+    }, [&]() {
+        rf = filterSub(r, items, mid + 1, last, keep, dropped, nextForks);
+    });
+    dropped.insert(dropped.end(), leftDropped.begin(), leftDropped.end());
+
+    if (same != NULL && keep)
+        return joinSub(lf, same, rf);
+    if (same != NULL)
+        dropped.push_back(same);
+    return joinSub(lf, rf);
+}
+
+/**@brief makes t the whole tree, after freeing the nodes in dropped
+   @param t the new contents, nodes from this tree's pool
+   @param dropped detached nodes (and their subtrees) to free
+*/
+template<class DataType>
+void BinTree<DataType>::setRoot(Subtree t,
+        const std::vector<Node<DataType>*>& dropped) {
+    for (Node<DataType>* n : dropped)
+        delNode(n);
+    root = t.root;
+    if (root != NULL)
+    {
+        root->parent = NULL;
+        root->red = false; //a red root is fine in a subtree, not the tree
+    }
+    nodeCount = sizeOf(root);
+    checkFilter();
+}
+
+/**@brief keeps (or removes) the items that are in a sorted list, O(n + m)
+   @param items pointers to the items, in ascending order
+   @param keep true to keep only the items in the list, false to keep only
+          the items that are not
+
+Walks the tree and the list side by side, then rebuilds the tree from what
+is left, for the schemes that can not be split and joined.
+*/
+template<class DataType>
+void BinTree<DataType>::filterBuild(const std::vector<const DataType*>& items,
+                                    bool keep) {
+    std::vector<const DataType*> kept;
+    size_t i = 0;
+    for (const DataType& data : *this)
+    {
+        while (i < items.size() && *items[i] < data)
+            i++;
+        bool found = i < items.size() && !(data < *items[i]);
+        if (found == keep)
+            kept.push_back(&data);
+    }
+    buildFrom(kept);
+}
+
+/**@brief runs left() and right(), at the same time if fork is true
+
+left() runs on a new thread while the calling thread runs right().
+*/
+template<class DataType>
+template<class Left, class Right>
+void BinTree<DataType>::forkJoin(bool fork, Left left, Right right) {
+    if (!fork)
+    {
+        left();
+        right();
+        return;
+    }
+    std::thread other(left);
+    right();
+    other.join();
+}
+
+/**@brief how many times the set operations may split their work in two
+   @param threads the number of threads wanted, 0 for one per hardware thread
+   @return enough splits to keep every thread busy
+*/
+template<class DataType>
+uint32_t BinTree<DataType>::forksFor(unsigned threads) {
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    uint32_t forks = 0;
+    while ((1u << forks) < threads)
+        forks++;
+    return forks;
+}
+
+/**@brief checks the filter for data, if there is one
+   @return true if data is definitely not in the tree
+*/
+template<class DataType>
+template<class Key>
+bool BinTree<DataType>::filterRejects(const Key& data) const {
+    if constexpr (std::is_same<Key, DataType>::value &&
+                  IsHashable<DataType>::value)
+    {
+        if (filter.enabled() && !filter.mayContain(std::hash<DataType>()(data)))
+        {
+            BINTREE_COUNT(filterCount, 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+///@brief adds data to the filter, if there is one
+template<class DataType>
+void BinTree<DataType>::filterAdd(const DataType& data) {
+    if constexpr (IsHashable<DataType>::value)
+    {
+        if (filter.enabled())
+            filter.add(std::hash<DataType>()(data));
+    }
+}
+
+///@brief sizes the filter for twice the current count and adds every item
+template<class DataType>
+void BinTree<DataType>::fillFilter(double falsePositiveRate) {
+    filter.resize(std::max<uint64_t>(2 * static_cast<uint64_t>(nodeCount),
+                                     minFilterKeys), falsePositiveRate);
+    for (const DataType& data : *this)
+        filterAdd(data);
+}
+
+/**@brief rebuilds the filter if it has outgrown its size, or if half of the
+          items it holds have been removed from the tree
+
+Only called once the tree is whole again, since the rebuild walks it.
+*/
+template<class DataType>
+void BinTree<DataType>::checkFilter() {
+    if (filter.enabled() &&
+        (filter.size() > filter.sizedFor() ||
+         (filter.size() > minFilterKeys && nodeCount < filter.size() / 2)))
+        fillFilter(filter.falsePositiveRate());
+}
+
+/**@brief finds where new data belongs in the tree
+   @param data the data that is about to be added (or anything that compares
+          with DataType the same way)
+   @param parent set to the node that the new node should hang from (NULL if
+          the tree is empty)
+   @return the node that already holds data, NULL if data is not in the tree
+
+When NULL is returned, every node passed on the way down already counts the
+new node in its size, so attach() must follow. If data is a duplicate, the
+size changes are undone, and a SPLAY tree moves the duplicate up.
+*/
+template<class DataType>
+template<class Key>
+Node<DataType>* BinTree<DataType>::findSlot(const Key& data,
+                                            Node<DataType>*& parent) {
+    Node<DataType>* current = root;
+    parent = NULL;
+
+    uint32_t compared = 0;
+
+    while (current != NULL)
+    {
+        parent = current;
+        current->size++;
+        compared++;
+        if (data < current->data)
+            current = current->left;
+        else if (current->data < data)
+            current = current->right;
+        else
+        {
+            for (Node<DataType>* n = current; n != NULL; n = n->parent)
+                n->size--;
+            compareCount.add(compared);
+            splay(current);
+            return current;
+        }
+    }
+    compareCount.add(compared);
+    return NULL;
+}
+
+/**@brief links a new node into the tree below parent
+   @param nn the new node
+   @param parent the parent found by findSlot()
+*/
+template<class DataType>
+void BinTree<DataType>::attach(Node<DataType>* nn, Node<DataType>* parent) {
+    nn->parent = parent;
+    if (parent == NULL)
+        root = nn;
+    else if (nn->data < parent->data)
+        parent->left = nn;
+    else
+        parent->right = nn;
+    nodeCount++;
+
+    if (balance == RED_BLACK)
+    {
+        nn->red = true;
+        insertFixup(nn);
+    }
+    else
+        splay(nn);
+    checkFilter();
+}
+
+/**@brief performs a binary search of the tree
+   @param data the data to look for
+   @param level set to the number of branches from root to the node
+   @param last if not NULL, set to the last node compared with (the node
+          that was found, NULL if the tree is empty), for splay()
+   @return the Node with the data, NULL if the data does not exist
+
+Disregard the level if the returned pointer is NULL
+*/
+template<class DataType>
+template<class Key>
+Node<DataType>* BinTree<DataType>::findNode(const Key& data,
+                                            uint32_t& level,
+                                            Node<DataType>** last) const {
+    Node<DataType>* n = root;
+    level = 0;
+    if (last != NULL)
+        *last = NULL;
+
+    while (n != NULL)
+    {
+        if (last != NULL)
+            *last = n;
+        if (data < n->data) //data is too small
+            n = n->left;
+        else if (n->data < data) //data is too big
+            n = n->right;
+        else
+        {
+            BINTREE_COUNT(compareCount, level + 1);
+            return n;
+        }
+        level++;
+    }
+    BINTREE_COUNT(compareCount, level);
+    return NULL;
+}
+
+/**@brief finds the first node with data >= the given data
+   @param data the data to compare with
+   @return the node, NULL if every node is smaller than data
+*/
+template<class DataType>
+template<class Key>
+Node<DataType>* BinTree<DataType>::lowerNode(const Key& data) const {
+    Node<DataType>* n = root;
+    Node<DataType>* best = NULL;
+    uint32_t compared = 0;
+
+    for (; n != NULL; compared++)
+    {
+        if (n->data < data)
+            n = n->right;
+        else
+        {
+            best = n;
+            n = n->left;
+        }
+    }
+    BINTREE_COUNT(compareCount, compared);
+    return best;
+}
+
+/**@brief finds the first node with data > the given data
+   @param data the data to compare with
+   @return the node, NULL if no node is bigger than data
+*/
+template<class DataType>
+template<class Key>
+Node<DataType>* BinTree<DataType>::upperNode(const Key& data) const {
+    Node<DataType>* n = root;
+    Node<DataType>* best = NULL;
+    uint32_t compared = 0;
+
+    for (; n != NULL; compared++)
+    {
+        if (data < n->data)
+        {
+            best = n;
+            n = n->left;
+        }
+        else
+            n = n->right;
+    }
+    BINTREE_COUNT(compareCount, compared);
+    return best;
+}
+
+/**@brief counts the items that are smaller than data
+   @param data the data to compare with
+   @param inclusive true to count items equal to data as well
+   @return the number of items found
+
+Whenever the search goes right, the node and its whole left subtree are
+smaller, so their sizes are added up along the way.
+*/
+template<class DataType>
+template<class Key>
+uint32_t BinTree<DataType>::countBelow(const Key& data,
+                                       bool inclusive) const {
+    Node<DataType>* n = root;
+    uint32_t below = 0;
+
+    while (n != NULL)
+    {
+        if (n->data < data || (inclusive && !(data < n->data)))
+        {
+            below += sizeOf(n->left) + 1;
+            n = n->right;
+        }
+        else
+            n = n->left;
+    }
+    return below;
+}
+
+///@brief get the size of the subtree at n, 0 for NULL
+template<class DataType>
+uint32_t BinTree<DataType>::sizeOf(const Node<DataType>* n) {
+    return (n == NULL) ? 0 : n->size;
+}
+
+///@brief get the smallest node under n (including n), NULL if n is NULL
+template<class DataType>
+Node<DataType>* BinTree<DataType>::leftmost(Node<DataType>* n) {
+    if (n != NULL)
+    {
+        while (n->left != NULL)
+            n = n->left;
+    }
+    return n;
+}
+
+///@brief get the largest node under n (including n), NULL if n is NULL
+template<class DataType>
+Node<DataType>* BinTree<DataType>::rightmost(Node<DataType>* n) {
+    if (n != NULL)
+    {
+        while (n->right != NULL)
+            n = n->right;
+    }
+    return n;
+}
+
+/**@brief get the next node in order
+   @param n the current node
+   @return the node after n, NULL if n is the last node
+
+If n has a right subtree, the next node is the smallest node in it. Otherwise,
+it is the first parent that n is in the left subtree of.
+*/
+template<class DataType>
+Node<DataType>* BinTree<DataType>::successor(Node<DataType>* n) {
+    if (n->right != NULL)
+        return leftmost(n->right);
+
+    Node<DataType>* parent = n->parent;
+    while (parent != NULL && n == parent->right)
+    {
+        n = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+///@brief get the previous node in order, the mirror image of successor()
+template<class DataType>
+Node<DataType>* BinTree<DataType>::predecessor(Node<DataType>* n) {
+    if (n->left != NULL)
+        return rightmost(n->left);
+
+    Node<DataType>* parent = n->parent;
+    while (parent != NULL && n == parent->left)
+    {
+        n = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+/**@brief cuts the tree into subtrees for parallelTraverse()/parallelReduce()
+   @param want the number of subtrees to aim for
+   @param tasks set to the roots of the subtrees, all on the same level
+   @param above set to the nodes above the subtrees, with their levels
+   @return the level the subtrees start on
+
+Goes down one level at a time until there are at least want subtrees. A
+level with no more nodes than the last one (a lopsided tree) ends the
+search early, so above never holds more than a few levels.
+*/
+template<class DataType>
+uint32_t BinTree<DataType>::splitTasks(size_t want,
+        std::vector<Node<DataType>*>& tasks,
+        std::vector<std::pair<Node<DataType>*, uint32_t> >& above) const {
+    uint32_t level = 0;
+    tasks.clear();
+    if (root != NULL)
+        tasks.push_back(root);
+
+    std::vector<Node<DataType>*> next;
+    while (tasks.size() < want)
+    {
+        next.clear();
+        for (Node<DataType>* n : tasks)
+        {
+            if (n->left != NULL)
+                next.push_back(n->left);
+            if (n->right != NULL)
+                next.push_back(n->right);
+        }
+        if (next.size() <= tasks.size())
+            break;
+        for (Node<DataType>* n : tasks)
+            above.push_back(std::make_pair(n, level));
+        tasks.swap(next);
+        level++;
+    }
+    return level;
+}
+
+/**@brief runs task(0) through task(taskCount - 1) on a pool of threads
+   @param taskCount the number of tasks
+   @param threads the number of threads, including the calling thread
+   @param task called as task(i) for each i, from any of the threads
+
+Each thread takes the next task number from a shared counter until there
+are none left, so faster threads simply run more tasks.
+*/
+template<class DataType>
+template<class Task>
+void BinTree<DataType>::runTasks(size_t taskCount, unsigned threads,
+                                 Task task) {
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        for (size_t i = next++; i < taskCount; i = next++)
+            task(i);
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads && t < taskCount; t++)
+        pool.emplace_back(work);
+    work();
+    for (std::thread& t : pool)
+        t.join();
+}
+
+/**@brief calls visit(args...), true unless visit returned false
+
+Lets visitors either return nothing (never stop) or a bool (stop on false).
+*/
+template<class DataType>
+template<class Visit, class... Args>
+bool BinTree<DataType>::keepGoing(Visit& visit, Args&&... args) {
+    typedef decltype(visit(std::forward<Args>(args)...)) Returns;
+    if constexpr (std::is_void<Returns>::value)
+    {
+        visit(std::forward<Args>(args)...);
+        return true;
+    }
+    else
+        return static_cast<bool>(visit(std::forward<Args>(args)...));
+}
+
+/**@brief visits every node below (and including) n in the specified order
+@param order IN_ORDER, PRE_ORDER, or POST_ORDER, see below
+@param n the node to start at
+@param visit The function to run on each node, called as visit(node, level)
+       where level is the number of branches from n (n = 0). It may return
+       false to end the walk (see keepGoing()).
+@return false if visit ended the walk early
+
+No recursion is used. The walk follows parent pointers back up the tree and
+uses the node it just came from to decide where to go next, so it takes no
+extra memory and works on trees of any depth.
+
+A tree set up like this (* has a value, x is NULL)...
+
+0|     *
+||   /   \
+1|  *     *
+|| / \   / \
+2|x   *  x  *
+||   / \   / \
+3|  *   *  x  *
+
+...will be traversed like this (numbers are the order in which the
+function is run).
+
+IN_ORDER: left subtree, node, right subtree
+
+0|     5
+||   /   \
+1|  1     6
+|| / \   / \
+2|x   3  x  7
+||   / \   / \
+3|  2   4  x  8
+
+PRE_ORDER: node, left subtree, right subtree
+
+0|     1
+||   /   \
+1|  2     6
+|| / \   / \
+2|x   3  x  7
+||   / \   / \
+3|  4   5  x  8
+
+POST_ORDER: left subtree, right subtree, node
+
+0|     8
+||   /   \
+1|  4     7
+|| / \   / \
+2|x   3  x  6
+||   / \   / \
+3|  1   2  x  5
+*/
+template<class DataType>
+template<class Visit>
+bool BinTree<DataType>::walk(TreeTraverse order, Node<DataType>* n,
+                             Visit visit) {
+    if (n == NULL)
+        return true;
+
+    Node<DataType>* const top = n;
+    Node<DataType>* prev = n->parent; //pretend we just came down to n
+    uint32_t level = 0;
+
+    while (true)
+    {
+        if (prev == n->parent) //came down, n has not been seen yet
+        {
+            if (order == PRE_ORDER && !keepGoing(visit, n, level))
+                return false;
+            if (n->left != NULL)
+            {
+                prev = n;
+                n = n->left;
+                level++;
+                continue;
+            }
+            prev = n->left; //no left subtree, act like it was finished
+        }
+
+        if (prev == n->left) //left subtree finished
+        {
+            if (order == IN_ORDER && !keepGoing(visit, n, level))
+                return false;
+            if (n->right != NULL)
+            {
+                prev = n;
+                n = n->right;
+                level++;
+                continue;
+            }
+        }
+
+        //right subtree finished
+        if (order == POST_ORDER && !keepGoing(visit, n, level))
+            return false;
+        if (n == top)
+            return true;
+        prev = n;
+        n = n->parent;
+        level--;
     }
 }
 
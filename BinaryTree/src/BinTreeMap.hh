@@ -0,0 +1,348 @@
+///@file BinTreeMap.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef BINTREEMAP_HH
+#define BINTREEMAP_HH
+
+#include <utility>
+#include <iterator>
+#include <type_traits>
+#include "BinTree.hh"
+
+/**@brief One key and its value, stored in a BinTreeMap
+
+Entries are ordered by key alone, so they can be compared with a bare key and
+a lookup never has to build a whole entry. The value is not part of the
+order, so it can be changed through a non-const BinTreeMap::iterator while the
+entry is in the tree. The key is const and can never change.
+*/
+template<class Key, class Value>
+struct MapEntry {
+    const Key first;
+    Value second;
+
+    ///@brief builds the key from key, and the value from args
+    template<class K, class... Args>
+    explicit MapEntry(K&& key, Args&&... args)
+        : first(std::forward<K>(key)), second(std::forward<Args>(args)...) {}
+};
+
+template<class Key, class Value>
+bool operator<(const MapEntry<Key, Value>& left,
+               const MapEntry<Key, Value>& right) {
+    return left.first < right.first;
+}
+
+template<class Key, class Value, class K>
+bool operator<(const MapEntry<Key, Value>& left, const K& right) {
+    return left.first < right;
+}
+
+template<class Key, class Value, class K>
+bool operator<(const K& left, const MapEntry<Key, Value>& right) {
+    return left < right.first;
+}
+
+/**@brief A sorted map from keys to values, built on BinTree
+
+Each node holds a MapEntry (key and value side by side), and every lookup
+compares keys only. Lookups return iterators (or the value itself), so the
+data is reached in the same walk that finds it.
+
+~~~~~{.cc}
+BinTreeMap<string, int> ages;
+ages["Kirk"] = 34;
+ages.try_emplace("Spock", 161);
+if (int* age = ages.search("Kirk"))
+    (*age)++;
+for (auto& entry : ages)
+    entry.second *= 2;
+for (const auto& entry : ages)
+    cout << entry.first << " " << entry.second << endl;
+~~~~~
+
+@tparam Key the type of the keys, compared with <
+@tparam Value the type of the values
+*/
+template<class Key, class Value>
+class BinTreeMap {
+public:
+    typedef MapEntry<Key, Value> Entry;
+
+    /**@brief A bidirectional iterator over the entries in key order
+
+    Wraps a BinTree iterator. A const_iterator gives const Entry&, an iterator
+    gives Entry&, whose key is still const. An iterator converts to a
+    const_iterator, not the other way around.
+    @tparam Const true for const_iterator
+    */
+    template<bool Const>
+    class Iterator {
+    private:
+        typename BinTree<Entry>::iterator i; ///< the position in the tree
+        friend class BinTreeMap<Key, Value>;
+        explicit Iterator(typename BinTree<Entry>::iterator i) : i(i) {}
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef Entry value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<Const, const Entry*, Entry*>::type
+            pointer;
+        typedef typename std::conditional<Const, const Entry&, Entry&>::type
+            reference;
+
+        Iterator() {}
+        ///@brief an iterator converts to a const_iterator
+        template<bool C, class = typename std::enable_if<Const && !C>::type>
+        Iterator(const Iterator<C>& other) : i(other.i) {}
+        //the entry itself is not const, only the tree's view of it is
+        reference operator*() const { return const_cast<reference>(*i); }
+        pointer operator->() const { return &**this; }
+        Iterator& operator++() {
+            ++i;
+            return *this;
+        }
+        Iterator& operator--() {
+            --i;
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++i;
+            return old;
+        }
+        Iterator operator--(int) {
+            Iterator old = *this;
+            --i;
+            return old;
+        }
+        template<bool C>
+        bool operator==(const Iterator<C>& right) const {
+            return i == right.i;
+        }
+        template<bool C>
+        bool operator!=(const Iterator<C>& right) const {
+            return i != right.i;
+        }
+        template<bool C> friend class Iterator;
+    };
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+private:
+    BinTree<Entry> tree;
+public:
+    BinTreeMap(TreeBalance balance = RED_BLACK); ///< default constructor
+    //MANAGE DATA//////////////////////////////////////////////
+    uint32_t count() const; ///< get the number of keys in the map
+    TreeBalance getBalance() const; ///< get the balancing scheme
+    template<class K>
+    iterator find(const K& key);
+    template<class K>
+    const_iterator find(const K& key) const;
+    template<class K>
+    Value* search(const K& key);
+    template<class K>
+    const Value* search(const K& key) const;
+    template<class K>
+    bool contains(const K& key) const;
+    Value& operator[](const Key& key);
+    Value& operator[](Key&& key);
+    template<class K, class... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args);
+    template<class K, class V>
+    std::pair<iterator, bool> insert_or_assign(K&& key, V&& value);
+    template<class K>
+    const bool remove(const K& key);
+    void erase(); ///< erases the contents of the map
+    //ITERATE//////////////////////////////////////////////////
+    iterator begin(); ///< get the entry with the smallest key
+    const_iterator begin() const;
+    iterator end(); ///< get the position after the largest key
+    const_iterator end() const;
+    template<class K>
+    iterator lower_bound(const K& key);
+    template<class K>
+    const_iterator lower_bound(const K& key) const;
+    template<class K>
+    iterator upper_bound(const K& key);
+    template<class K>
+    const_iterator upper_bound(const K& key) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+/**@brief default constructor
+   @param balance the balancing scheme to use, RED_BLACK by default so that
+          lookups stay O(log n) whatever order the keys arrive in
+*/
+template<class Key, class Value>
+BinTreeMap<Key, Value>::BinTreeMap(TreeBalance balance) : tree(balance) {}
+
+///////////////////////////////////////////////////////////////////////////////
+//PUBLIC
+template<class Key, class Value>
+uint32_t BinTreeMap<Key, Value>::count() const {
+    return tree.count();
+}
+
+template<class Key, class Value>
+TreeBalance BinTreeMap<Key, Value>::getBalance() const {
+    return tree.getBalance();
+}
+
+/**@brief looks up a key
+   @param key the key, or anything that compares with Key using <
+   @return an iterator to the entry, end() if the key is not in the map
+*/
+template<class Key, class Value>
+template<class K>
+typename BinTreeMap<Key, Value>::iterator
+BinTreeMap<Key, Value>::find(const K& key) {
+    return iterator(tree.find(key));
+}
+
+template<class Key, class Value>
+template<class K>
+typename BinTreeMap<Key, Value>::const_iterator
+BinTreeMap<Key, Value>::find(const K& key) const {
+    return const_iterator(tree.find(key));
+}
+
+/**@brief looks up the value for a key
+   @param key the key to look up
+   @return a pointer to the value, NULL if the key is not in the map
+*/
+template<class Key, class Value>
+template<class K>
+Value* BinTreeMap<Key, Value>::search(const K& key) {
+    iterator i = find(key);
+    return (i == end()) ? NULL : &i->second;
+}
+
+template<class Key, class Value>
+template<class K>
+const Value* BinTreeMap<Key, Value>::search(const K& key) const {
+    const_iterator i = find(key);
+    return (i == end()) ? NULL : &i->second;
+}
+
+template<class Key, class Value>
+template<class K>
+bool BinTreeMap<Key, Value>::contains(const K& key) const {
+    return tree.find(key) != tree.end();
+}
+
+/**@brief gets the value for a key, adding the key if it is not there
+   @return the value, a default-constructed Value if the key was added
+*/
+template<class Key, class Value>
+Value& BinTreeMap<Key, Value>::operator[](const Key& key) {
+    return try_emplace(key).first->second;
+}
+
+template<class Key, class Value>
+Value& BinTreeMap<Key, Value>::operator[](Key&& key) {
+    return try_emplace(std::move(key)).first->second;
+}
+
+/**@brief adds a key with a value built from args, if the key is not there
+   @param key the key to add
+   @param args the arguments for one of Value's constructors
+   @return an iterator to the entry with that key, and true if it was added
+
+If the key is already in the map, nothing is built, key and args are left
+unchanged, and the existing value is kept.
+*/
+template<class Key, class Value>
+template<class K, class... Args>
+std::pair<typename BinTreeMap<Key, Value>::iterator, bool>
+BinTreeMap<Key, Value>::try_emplace(K&& key, Args&&... args) {
+    auto result = tree.emplaceKey(key, std::forward<K>(key),
+                                  std::forward<Args>(args)...);
+    return std::make_pair(iterator(result.first), result.second);
+}
+
+/**@brief sets the value for a key, adding the key if it is not there
+   @return an iterator to the entry, and true if the key was added
+*/
+template<class Key, class Value>
+template<class K, class V>
+std::pair<typename BinTreeMap<Key, Value>::iterator, bool>
+BinTreeMap<Key, Value>::insert_or_assign(K&& key, V&& value) {
+    auto result =
+        tree.emplaceKey(key, std::forward<K>(key), std::forward<V>(value));
+    iterator i(result.first);
+    if (!result.second)
+        i->second = std::forward<V>(value);
+    return std::make_pair(i, result.second);
+}
+
+/**@brief removes a key and its value
+   @return false if the key was not in the map
+*/
+template<class Key, class Value>
+template<class K>
+const bool BinTreeMap<Key, Value>::remove(const K& key) {
+    return tree.remove(key);
+}
+
+template<class Key, class Value>
+void BinTreeMap<Key, Value>::erase() {
+    tree.erase();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//ITERATE
+template<class Key, class Value>
+typename BinTreeMap<Key, Value>::iterator BinTreeMap<Key, Value>::begin() {
+    return iterator(tree.begin());
+}
+
+template<class Key, class Value>
+typename BinTreeMap<Key, Value>::const_iterator
+BinTreeMap<Key, Value>::begin() const {
+    return const_iterator(tree.begin());
+}
+
+template<class Key, class Value>
+typename BinTreeMap<Key, Value>::iterator BinTreeMap<Key, Value>::end() {
+    return iterator(tree.end());
+}
+
+template<class Key, class Value>
+typename BinTreeMap<Key, Value>::const_iterator
+BinTreeMap<Key, Value>::end() const {
+    return const_iterator(tree.end());
+}
+
+///@brief finds the first entry with a key >= key, end() if there is none
+template<class Key, class Value>
+template<class K>
+typename BinTreeMap<Key, Value>::iterator
+BinTreeMap<Key, Value>::lower_bound(const K& key) {
+    return iterator(tree.lower_bound(key));
+}
+
+template<class Key, class Value>
+template<class K>
+typename BinTreeMap<Key, Value>::const_iterator
+BinTreeMap<Key, Value>::lower_bound(const K& key) const {
+    return const_iterator(tree.lower_bound(key));
+}
+
+///@brief finds the first entry with a key > key, end() if there is none
+template<class Key, class Value>
+template<class K>
+typename BinTreeMap<Key, Value>::iterator
+BinTreeMap<Key, Value>::upper_bound(const K& key) {
+    return iterator(tree.upper_bound(key));
+}
+
+template<class Key, class Value>
+template<class K>
+typename BinTreeMap<Key, Value>::const_iterator
+BinTreeMap<Key, Value>::upper_bound(const K& key) const {
+    return const_iterator(tree.upper_bound(key));
+}
+
+#endif // BINTREEMAP_HH
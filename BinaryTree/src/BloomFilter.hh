@@ -0,0 +1,194 @@
+///@file BloomFilter.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef BLOOMFILTER_HH
+#define BLOOMFILTER_HH
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+///@brief true if std::hash<T> can hash a T
+template<class T, class = void>
+struct IsHashable : std::false_type {};
+
+template<class T>
+struct IsHashable<T, decltype(void(std::hash<T>()(std::declval<const T&>())))>
+    : std::true_type {};
+
+/**@brief A blocked Bloom filter: answers "definitely not there" or "maybe"
+
+Keys are given as hashes (see std::hash). Each key sets a few bits, all in
+the same 64-byte block, so checking a key touches one cache line no matter
+how many bits it sets. A key that was added always answers "maybe". A key
+that was not added answers "maybe" with about the false positive rate the
+filter was sized for, as long as no more keys than that were added.
+
+Bits can not be taken back out, so a filter only grows. BinTree rebuilds
+its filter when too many of its keys were removed (see BinTree::enableFilter).
+
+* Memory: about 1.44*lg(1/rate) + 1 bits per key, e.g. 1.3 bytes per key for
+  1%. The extra bit makes up for keys crowding into the same block.
+* add() and mayContain() never allocate, and mayContain() only reads, so it
+  is safe from several threads at once (add() is not)
+*/
+class BloomFilter {
+private:
+    ///@brief one cache line of bits, all of a key's bits are in one block
+    struct alignas(64) Block {
+        uint64_t bits[8];
+    };
+    static constexpr uint32_t blockBits = 512;
+    static constexpr uint32_t maxHashes = 16;
+
+    std::vector<Block> blocks;
+    uint32_t hashes;   ///< the number of bits set for each key
+    uint64_t keys;     ///< keys added since the filter was last cleared
+    uint64_t capacity; ///< the number of keys the filter was sized for
+    double rate;       ///< the false positive rate wanted at capacity
+
+    static uint64_t mix(uint64_t hash);
+    size_t blockOf(uint64_t mixed) const;
+    ///@brief steps to a key's next bit, held in the top 9 bits of the result
+    static uint64_t nextBit(uint64_t bit) {
+        return bit * 0x9E3779B97F4A7C15ull + 0x632BE59BD9B4E019ull;
+    }
+    ///@brief the word (0 to 7) of its block that a bit from nextBit() is in
+    static uint32_t wordOf(uint64_t bit) { return bit >> 61; }
+    ///@brief the mask for a bit from nextBit() within its word
+    static uint64_t maskOf(uint64_t bit) {
+        return static_cast<uint64_t>(1) << (bit >> 55 & 63);
+    }
+public:
+    BloomFilter(); ///< an empty filter, not enabled until resize()
+    void resize(uint64_t capacity, double rate);
+    void clear(); ///< forgets every key, keeps the size
+    void release(); ///< frees the bits, the filter is no longer enabled
+    bool enabled() const; ///< whether resize() has been called
+    void add(uint64_t hash);
+    bool mayContain(uint64_t hash) const;
+    uint64_t size() const; ///< get the number of keys added
+    uint64_t sizedFor() const; ///< get the number of keys it was sized for
+    double falsePositiveRate() const; ///< get the rate it was sized for
+    size_t memory() const; ///< get the number of bytes the bits take
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+inline BloomFilter::BloomFilter() {
+    hashes = 0;
+    keys = 0;
+    capacity = 0;
+    rate = 0;
+}
+
+/**@brief sizes the filter, and forgets every key
+   @param capacity the number of keys to make room for
+   @param rate the false positive rate wanted with capacity keys in it,
+          between 0 and 1 (0.01 for 1%)
+*/
+inline void BloomFilter::resize(uint64_t capacity, double rate) {
+    if (capacity == 0)
+        capacity = 1;
+    rate = std::min(std::max(rate, 1e-9), 0.5);
+    const double bitsPerKey = 1.44 * std::log2(1 / rate) + 1;
+    const uint64_t bits = static_cast<uint64_t>(capacity * bitsPerKey) + 1;
+    //about ln(2) bits per key to set gives the fewest false positives
+    hashes = static_cast<uint32_t>(std::lround(bitsPerKey * 0.693));
+    hashes = std::min(std::max(hashes, 1u), maxHashes);
+
+    blocks.assign((bits + blockBits - 1) / blockBits, Block());
+    keys = 0;
+    this->capacity = capacity;
+    this->rate = rate;
+}
+
+inline void BloomFilter::clear() {
+    std::fill(blocks.begin(), blocks.end(), Block());
+    keys = 0;
+}
+
+inline void BloomFilter::release() {
+    std::vector<Block>().swap(blocks);
+    hashes = 0;
+    keys = 0;
+    capacity = 0;
+    rate = 0;
+}
+
+inline bool BloomFilter::enabled() const {
+    return !blocks.empty();
+}
+
+///@brief adds a key, given its hash
+inline void BloomFilter::add(uint64_t hash) {
+    const uint64_t mixed = mix(hash);
+    Block& block = blocks[blockOf(mixed)];
+    uint64_t bit = mixed;
+    for (uint32_t i = 0; i < hashes; i++)
+    {
+        bit = nextBit(bit);
+        block.bits[wordOf(bit)] |= maskOf(bit);
+    }
+    keys++;
+}
+
+/**@brief checks for a key, given its hash
+   @return false if the key was definitely never added, true if it may have
+           been
+*/
+inline bool BloomFilter::mayContain(uint64_t hash) const {
+    const uint64_t mixed = mix(hash);
+    const Block& block = blocks[blockOf(mixed)];
+    uint64_t bit = mixed;
+    for (uint32_t i = 0; i < hashes; i++)
+    {
+        bit = nextBit(bit);
+        if (!(block.bits[wordOf(bit)] & maskOf(bit)))
+            return false;
+    }
+    return true;
+}
+
+inline uint64_t BloomFilter::size() const {
+    return keys;
+}
+
+inline uint64_t BloomFilter::sizedFor() const {
+    return capacity;
+}
+
+inline double BloomFilter::falsePositiveRate() const {
+    return rate;
+}
+
+inline size_t BloomFilter::memory() const {
+    return blocks.size() * sizeof(Block);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+/**@brief spreads a hash over all 64 bits
+
+std::hash of an integer is often the integer itself, which would put
+neighbouring keys in neighbouring blocks and set the same bits in each.
+*/
+inline uint64_t BloomFilter::mix(uint64_t hash) {
+    hash ^= hash >> 30;
+    hash *= 0xBF58476D1CE4E5B9ull;
+    hash ^= hash >> 27;
+    hash *= 0x94D049BB133111EBull;
+    return hash ^ (hash >> 31);
+}
+
+///@brief picks a block from the top 32 bits of a mixed hash
+inline size_t BloomFilter::blockOf(uint64_t mixed) const {
+    return (mixed >> 32) * blocks.size() >> 32;
+}
+
+#endif // BLOOMFILTER_HH
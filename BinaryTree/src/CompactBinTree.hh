@@ -0,0 +1,906 @@
+///@file CompactBinTree.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef COMPACTBINTREE_HH
+#define COMPACTBINTREE_HH
+
+#include <new>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <initializer_list>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include "BinTree.hh"
+
+/**@brief A node of a CompactBinTree, linked by index instead of by pointer
+
+The top bit of left holds the node's color (set for red), the other 31 bits
+hold the index of the left child. For 8 bytes of data the node takes 16
+bytes, where a Node<uint64_t> takes 40.
+*/
+template<class DataType>
+struct CompactNode {
+    DataType data;
+    uint32_t left;  ///< the left child's index, and the color in the top bit
+    uint32_t right; ///< the right child's index, or the next free slot
+};
+
+/**@brief A sorted set with small nodes, for very large trees
+
+Works like a RED_BLACK BinTree, but each node only carries two 32-bit links
+next to its data: no parent pointer, no subtree size, and the color is
+packed into one of the links. The nodes sit in one array and link to each
+other by their position in it.
+
+* Per-node overhead is 8 bytes instead of 32, so 4 Node<uint64_t>s fit in
+  a cache line instead of 1.6, and the top levels of the tree take fewer
+  lines to keep in the cache
+* The tree is a left-leaning red-black tree: a red node is always the left
+  child of its parent, which keeps insert and remove short enough to write
+  without parent pointers (the search path is the recursion). The height
+  never exceeds 2*lg(n + 1), like RED_BLACK.
+* It holds up to 2^31 - 2 items. The array doubles as it fills, so a
+  reference to an item is only valid until the next insert.
+* Iterators carry the path from the root to their item (there is no parent
+  to climb back to), so they take about 270 bytes, and any insert or remove
+  makes every iterator invalid.
+* There are no order statistics (select(), rank()...), which would need
+  the subtree sizes this tree leaves out.
+
+@tparam DataType the type of data to store, compared with <
+*/
+template<class DataType>
+class CompactBinTree {
+private:
+    typedef CompactNode<DataType> Node;
+    static constexpr uint32_t nil = 0x7FFFFFFF; ///< the index of no node
+    static constexpr uint32_t redBit = 0x80000000;
+    static constexpr uint32_t maxHeight = 64; ///< more than 2*lg(nil + 1)
+    static constexpr uint32_t firstCapacity = 16;
+
+    Node* nodes;       ///< every slot, in use or free
+    uint32_t capacity; ///< the number of slots
+    uint32_t used;     ///< slots that have been handed out at least once
+    uint32_t freeList; ///< freed slots, linked through right
+    uint32_t root;
+    uint32_t nodeCount;
+
+    uint32_t left(uint32_t n) const { return nodes[n].left & ~redBit; }
+    uint32_t right(uint32_t n) const { return nodes[n].right; }
+    bool isRed(uint32_t n) const {
+        return n != nil && (nodes[n].left & redBit);
+    }
+    void setLeft(uint32_t n, uint32_t l) {
+        nodes[n].left = (nodes[n].left & redBit) | l;
+    }
+    void setRight(uint32_t n, uint32_t r) { nodes[n].right = r; }
+    void setRed(uint32_t n, bool red) {
+        nodes[n].left = left(n) | (red ? redBit : 0);
+    }
+
+    void reserveSlot();
+    void grow(uint32_t size);
+    template<class... Args>
+    uint32_t newNode(Args&&... args);
+    void freeNode(uint32_t n);
+    void destroy();
+    uint32_t clone(const CompactBinTree<DataType>& source, uint32_t n);
+    template<class Key>
+    uint32_t findIndex(const Key& data, uint32_t& level) const;
+
+    uint32_t rotateLeft(uint32_t n);
+    uint32_t rotateRight(uint32_t n);
+    void flipColors(uint32_t n);
+    uint32_t fixUp(uint32_t n);
+    uint32_t moveRedLeft(uint32_t n);
+    uint32_t moveRedRight(uint32_t n);
+    template<class Make>
+    uint32_t insertAt(uint32_t n, const DataType& data, Make& make,
+                      uint32_t& found, bool& added);
+    template<class Key>
+    uint32_t removeAt(uint32_t n, const Key& data);
+    uint32_t removeMin(uint32_t n, uint32_t& min);
+    template<class Make>
+    bool insertNode(const DataType& data, Make make, uint32_t& found);
+
+    uint32_t heightOf(uint32_t n) const;
+    template<class Visit>
+    bool walk(TreeTraverse order, uint32_t n, uint32_t level,
+              Visit& visit) const;
+public:
+    /**@brief A bidirectional iterator that visits the data in order
+
+    Holds the path from the root down to its item, since nodes have no
+    parent link to follow back up. Any insert or remove makes it invalid.
+    */
+    class iterator {
+    private:
+        const CompactBinTree<DataType>* tree;
+        uint32_t path[maxHeight]; ///< root first, the current item last
+        uint32_t depth;           ///< the length of path, 0 for end()
+        friend class CompactBinTree<DataType>;
+        explicit iterator(const CompactBinTree<DataType>* tree)
+            : tree(tree), depth(0) {}
+        uint32_t current() const { return path[depth - 1]; }
+        ///@brief goes down from n, always to the left (or right)
+        void descend(uint32_t n, bool toLeft) {
+            for (; n != nil; n = toLeft ? tree->left(n) : tree->right(n))
+                path[depth++] = n;
+        }
+        ///@brief climbs until the node just left was a left (or right) child
+        void climb(bool fromLeft) {
+            uint32_t child;
+            do
+            {
+                child = path[--depth];
+            } while (depth > 0 &&
+                     (fromLeft ? tree->left(current())
+                               : tree->right(current())) != child);
+        }
+    public:
+        typedef std::bidirectional_iterator_tag iterator_category;
+        typedef DataType value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const DataType* pointer;
+        typedef const DataType& reference;
+
+        iterator() : tree(NULL), depth(0) {}
+        reference operator*() const { return tree->nodes[current()].data; }
+        pointer operator->() const { return &tree->nodes[current()].data; }
+        iterator& operator++() {
+            if (tree->right(current()) != nil)
+                descend(tree->right(current()), true);
+            else
+                climb(true);
+            return *this;
+        }
+        iterator& operator--() {
+            if (depth == 0)
+                descend(tree->root, false);
+            else if (tree->left(current()) != nil)
+                descend(tree->left(current()), false);
+            else
+                climb(false);
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator old = *this;
+            ++*this;
+            return old;
+        }
+        iterator operator--(int) {
+            iterator old = *this;
+            --*this;
+            return old;
+        }
+        bool operator==(const iterator& right) const {
+            return depth == right.depth &&
+                   (depth == 0 || current() == right.current());
+        }
+        bool operator!=(const iterator& right) const {
+            return !(*this == right);
+        }
+    };
+    typedef iterator const_iterator;
+
+    ///@brief A pair of iterators that can be used in a range-based for loop
+    class Range {
+    private:
+        iterator first, last;
+    public:
+        Range(iterator first, iterator last) : first(first), last(last) {}
+        iterator begin() const { return first; }
+        iterator end() const { return last; }
+        bool empty() const { return first == last; }
+    };
+
+    CompactBinTree(); ///< default constructor
+    CompactBinTree(std::initializer_list<DataType> data);
+    ~CompactBinTree();
+    //MANAGE DATA//////////////////////////////////////////////
+    uint32_t count() const; ///< get the number of items in the tree
+    uint32_t height() const;
+    TreeBalance getBalance() const; ///< always RED_BLACK
+    size_t memory() const;
+    void insert(const DataType& data);
+    void insert(DataType&& data);
+    void insert(std::initializer_list<DataType> data);
+    template<class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    template<class Key>
+    const bool remove(const Key& data);
+    template<class Key>
+    const std::pair<bool, uint32_t> search(const Key& data) const;
+    template<class Visit>
+    bool traverse(TreeTraverse order, Visit&& visit) const;
+    void erase(); ///< erases the contents of the tree, and frees the array
+    //ITERATE//////////////////////////////////////////////////
+    iterator begin() const; ///< get the smallest item
+    iterator end() const; ///< get the position after the largest item
+    template<class Key>
+    iterator find(const Key& data) const;
+    template<class Key>
+    iterator lower_bound(const Key& data) const;
+    template<class Key>
+    iterator upper_bound(const Key& data) const;
+    Range range(const DataType& low, const DataType& high) const;
+    //COPY/////////////////////////////////////////////////////
+    CompactBinTree(const CompactBinTree<DataType>& source);
+    CompactBinTree(CompactBinTree<DataType>&& source);
+    CompactBinTree<DataType>&
+    operator=(const CompactBinTree<DataType>& right);
+    CompactBinTree<DataType>& operator=(CompactBinTree<DataType>&& right);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+template<class DataType>
+CompactBinTree<DataType>::CompactBinTree() {
+    nodes = NULL;
+    capacity = 0;
+    used = 0;
+    freeList = nil;
+    root = nil;
+    nodeCount = 0;
+}
+
+///@brief starting value constructor, data may be in any order
+template<class DataType>
+CompactBinTree<DataType>::CompactBinTree(std::initializer_list<DataType> data)
+    : CompactBinTree() {
+    insert(data);
+}
+
+template<class DataType>
+CompactBinTree<DataType>::~CompactBinTree() {
+    destroy();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PUBLIC
+template<class DataType>
+uint32_t CompactBinTree<DataType>::count() const {
+    return nodeCount;
+}
+
+/**@brief Get the number of levels in the tree
+   @return the number of nodes on the longest path from root to a leaf,
+           0 if the tree is empty
+*/
+template<class DataType>
+uint32_t CompactBinTree<DataType>::height() const {
+    return heightOf(root);
+}
+
+template<class DataType>
+TreeBalance CompactBinTree<DataType>::getBalance() const {
+    return RED_BLACK;
+}
+
+/**@brief get the number of bytes the node array takes
+
+Includes free slots and the room left for growth, but not anything the
+items own themselves (such as a string's characters).
+*/
+template<class DataType>
+size_t CompactBinTree<DataType>::memory() const {
+    return static_cast<size_t>(capacity) * sizeof(Node);
+}
+
+/**@brief adds data to the tree
+   @param data the data to add
+
+The slot is only filled once the data is known not to be a duplicate.
+*/
+template<class DataType>
+void CompactBinTree<DataType>::insert(const DataType& data) {
+    if (freeList == nil && used == capacity)
+    {
+        //growing would move data if it is one of this tree's items
+        insert(DataType(data));
+        return;
+    }
+    uint32_t found;
+    insertNode(data, [this, &data]() { return newNode(data); }, found);
+}
+
+///@brief adds data to the tree, moving it instead of copying
+template<class DataType>
+void CompactBinTree<DataType>::insert(DataType&& data) {
+    uint32_t found;
+    reserveSlot();
+    insertNode(data, [this, &data]() { return newNode(std::move(data)); },
+               found);
+}
+
+///@brief insert multiple pieces of data, in any order
+template<class DataType>
+void CompactBinTree<DataType>::insert(std::initializer_list<DataType> data) {
+    for (const DataType& i : data)
+        insert(i);
+}
+
+/**@brief builds data directly in a new node, then adds it to the tree
+   @param args the arguments for one of DataType's constructors
+   @return an iterator to the data in the tree, and false if it was a
+           duplicate (the iterator points to the item that was already there)
+*/
+template<class DataType>
+template<class... Args>
+std::pair<typename CompactBinTree<DataType>::iterator, bool>
+CompactBinTree<DataType>::emplace(Args&&... args) {
+    uint32_t nn = newNode(std::forward<Args>(args)...);
+    uint32_t found;
+    const bool added = insertNode(nodes[nn].data, [nn]() { return nn; },
+                                  found);
+    iterator i = find(nodes[found].data);
+    if (!added)
+        freeNode(nn);
+    return std::make_pair(i, added);
+}
+
+/**@brief remove some data from the tree
+   @param data the data to remove, anything that can be compared with
+          DataType using < (in both directions)
+   @return true if the data was found and removed, false if the data
+           does not exist
+*/
+template<class DataType>
+template<class Key>
+const bool CompactBinTree<DataType>::remove(const Key& data) {
+    uint32_t level;
+    if (findIndex(data, level) == nil)
+        return false;
+
+    //removeAt() needs root or a child of root to be red on the way down
+    if (!isRed(left(root)) && !isRed(right(root)))
+        setRed(root, true);
+    root = removeAt(root, data);
+    if (root != nil)
+        setRed(root, false);
+    nodeCount--;
+    return true;
+}
+
+/**@brief performs a binary search of the tree
+   @param data the data to search for
+   @return an std::pair<bool, uint32_t> of whether the data exists and the
+           level that the data is on (disregard the level if it does not)
+*/
+template<class DataType>
+template<class Key>
+const std::pair<bool, uint32_t>
+CompactBinTree<DataType>::search(const Key& data) const {
+    uint32_t level;
+    if (findIndex(data, level) == nil)
+        return std::make_pair(false, 0);
+    return std::make_pair(true, level);
+}
+
+/**@brief runs a function on every node in the tree in the specified order
+   @param order IN_ORDER, PRE_ORDER, or POST_ORDER (see BinTree::walk())
+   @param visit called as visit(const DataType& data, uint32_t level). If it
+          returns a bool, returning false stops the traversal.
+   @return false if visit stopped the traversal early
+
+The walk is recursive, which is safe here since the height is bounded.
+*/
+template<class DataType>
+template<class Visit>
+bool CompactBinTree<DataType>::traverse(TreeTraverse order,
+                                        Visit&& visit) const {
+    return walk(order, root, 0, visit);
+}
+
+template<class DataType>
+void CompactBinTree<DataType>::erase() {
+    destroy();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//ITERATE
+template<class DataType>
+typename CompactBinTree<DataType>::iterator
+CompactBinTree<DataType>::begin() const {
+    iterator i(this);
+    i.descend(root, true);
+    return i;
+}
+
+template<class DataType>
+typename CompactBinTree<DataType>::iterator
+CompactBinTree<DataType>::end() const {
+    return iterator(this);
+}
+
+/**@brief looks up data in the tree
+   @return an iterator to the data, end() if it does not exist
+*/
+template<class DataType>
+template<class Key>
+typename CompactBinTree<DataType>::iterator
+CompactBinTree<DataType>::find(const Key& data) const {
+    iterator i(this);
+    for (uint32_t n = root; n != nil; )
+    {
+        i.path[i.depth++] = n;
+        if (data < nodes[n].data)
+            n = left(n);
+        else if (nodes[n].data < data)
+            n = right(n);
+        else
+            return i;
+    }
+    return end();
+}
+
+///@brief finds the first item >= data, end() if there is none
+template<class DataType>
+template<class Key>
+typename CompactBinTree<DataType>::iterator
+CompactBinTree<DataType>::lower_bound(const Key& data) const {
+    iterator i(this);
+    uint32_t bestDepth = 0;
+    for (uint32_t n = root; n != nil; )
+    {
+        i.path[i.depth++] = n;
+        if (nodes[n].data < data)
+            n = right(n);
+        else
+        {
+            bestDepth = i.depth;
+            n = left(n);
+        }
+    }
+    i.depth = bestDepth; //the path to the best node is a prefix of the search
+    return i;
+}
+
+///@brief finds the first item > data, end() if there is none
+template<class DataType>
+template<class Key>
+typename CompactBinTree<DataType>::iterator
+CompactBinTree<DataType>::upper_bound(const Key& data) const {
+    iterator i(this);
+    uint32_t bestDepth = 0;
+    for (uint32_t n = root; n != nil; )
+    {
+        i.path[i.depth++] = n;
+        if (data < nodes[n].data)
+        {
+            bestDepth = i.depth;
+            n = left(n);
+        }
+        else
+            n = right(n);
+    }
+    i.depth = bestDepth;
+    return i;
+}
+
+///@brief gets every item from low to high (including both)
+template<class DataType>
+typename CompactBinTree<DataType>::Range
+CompactBinTree<DataType>::range(const DataType& low,
+                                const DataType& high) const {
+    if (high < low)
+        return Range(end(), end());
+    return Range(lower_bound(low), upper_bound(high));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//COPY
+/**@brief copy constructor
+
+The copy has the same shape, but its nodes are laid out in preorder with no
+free slots, so the top of the tree (and each left child) sits right next to
+its parent.
+*/
+template<class DataType>
+CompactBinTree<DataType>::CompactBinTree(
+    const CompactBinTree<DataType>& source) : CompactBinTree() {
+    grow(source.nodeCount);
+    root = clone(source, source.root);
+    nodeCount = source.nodeCount;
+}
+
+template<class DataType>
+CompactBinTree<DataType>::CompactBinTree(CompactBinTree<DataType>&& source)
+    : CompactBinTree() {
+    *this = std::move(source);
+}
+
+template<class DataType>
+CompactBinTree<DataType>&
+CompactBinTree<DataType>::operator=(const CompactBinTree<DataType>& right) {
+    if (this == &right)
+        return *this;
+    destroy();
+    grow(right.nodeCount);
+    root = clone(right, right.root);
+    nodeCount = right.nodeCount;
+    return *this;
+}
+
+///@brief takes over right's array, right is left empty
+template<class DataType>
+CompactBinTree<DataType>&
+CompactBinTree<DataType>::operator=(CompactBinTree<DataType>&& right) {
+    if (this == &right)
+        return *this;
+    destroy();
+    std::swap(nodes, right.nodes);
+    std::swap(capacity, right.capacity);
+    std::swap(used, right.used);
+    std::swap(freeList, right.freeList);
+    std::swap(root, right.root);
+    std::swap(nodeCount, right.nodeCount);
+    return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+///@brief makes sure the next newNode() will not move the array
+template<class DataType>
+void CompactBinTree<DataType>::reserveSlot() {
+    if (freeList != nil || used < capacity)
+        return;
+    if (capacity == nil)
+        throw std::bad_alloc();
+    uint64_t size = (capacity == 0) ? firstCapacity
+                                    : static_cast<uint64_t>(capacity) * 2;
+    grow((size > nil) ? nil : size);
+}
+
+/**@brief moves the nodes to a bigger array
+   @param size the number of slots to have room for
+
+Only called while every slot up to used is in use (the free list is
+empty), so they can all be moved without checking.
+*/
+template<class DataType>
+void CompactBinTree<DataType>::grow(uint32_t size) {
+    if (size <= capacity)
+        return;
+    std::allocator<Node> alloc;
+    Node* bigger = alloc.allocate(size);
+    for (uint32_t i = 0; i < used; i++)
+    {
+        new (&bigger[i]) Node{std::move(nodes[i].data), nodes[i].left,
+                              nodes[i].right};
+        nodes[i].~Node();
+    }
+    if (nodes != NULL)
+        alloc.deallocate(nodes, capacity);
+    nodes = bigger;
+    capacity = size;
+}
+
+/**@brief builds data in a free slot
+   @return the new node's index, red with no children
+*/
+template<class DataType>
+template<class... Args>
+uint32_t CompactBinTree<DataType>::newNode(Args&&... args) {
+    reserveSlot();
+    uint32_t n;
+    if (freeList != nil)
+    {
+        n = freeList;
+        freeList = nodes[n].right;
+    }
+    else
+        n = used++;
+    new (&nodes[n]) Node{DataType(std::forward<Args>(args)...),
+                         nil | redBit, nil};
+    return n;
+}
+
+///@brief destroys a node's data and puts its slot on the free list
+template<class DataType>
+void CompactBinTree<DataType>::freeNode(uint32_t n) {
+    nodes[n].~Node();
+    nodes[n].right = freeList;
+    freeList = n;
+}
+
+///@brief destroys every item and frees the array
+template<class DataType>
+void CompactBinTree<DataType>::destroy() {
+    if (!std::is_trivially_destructible<DataType>::value)
+    {
+        auto destroyData = [](const DataType& data, uint32_t) {
+            data.~DataType();
+        };
+        walk(POST_ORDER, root, 0, destroyData);
+    }
+    if (nodes != NULL)
+        std::allocator<Node>().deallocate(nodes, capacity);
+    nodes = NULL;
+    capacity = 0;
+    used = 0;
+    freeList = nil;
+    root = nil;
+    nodeCount = 0;
+}
+
+/**@brief copies a subtree of source, node for node, in preorder
+   @param source the tree to copy from
+   @param n the root of the subtree in source
+   @return the index of the copy, the array must already have room for it
+*/
+template<class DataType>
+uint32_t CompactBinTree<DataType>::clone(
+    const CompactBinTree<DataType>& source, uint32_t n) {
+    if (n == nil)
+        return nil;
+    uint32_t c = newNode(source.nodes[n].data);
+    setRed(c, source.isRed(n));
+    setLeft(c, clone(source, source.left(n)));
+    setRight(c, clone(source, source.right(n)));
+    return c;
+}
+
+/**@brief performs a binary search of the tree
+   @param level set to the number of branches from root to the node
+   @return the node's index, nil if the data does not exist
+*/
+template<class DataType>
+template<class Key>
+uint32_t CompactBinTree<DataType>::findIndex(const Key& data,
+                                             uint32_t& level) const {
+    uint32_t n = root;
+    level = 0;
+    while (n != nil)
+    {
+        if (data < nodes[n].data)
+            n = left(n);
+        else if (nodes[n].data < data)
+            n = right(n);
+        else
+            return n;
+        level++;
+    }
+    return nil;
+}
+
+/**@brief rotates n down to the left, its (red) right child takes its place
+   @return the index of the node that took n's place
+*/
+template<class DataType>
+uint32_t CompactBinTree<DataType>::rotateLeft(uint32_t n) {
+    uint32_t r = right(n);
+    setRight(n, left(r));
+    setLeft(r, n);
+    setRed(r, isRed(n));
+    setRed(n, true);
+    return r;
+}
+
+///@brief rotates n down to the right, the mirror image of rotateLeft()
+template<class DataType>
+uint32_t CompactBinTree<DataType>::rotateRight(uint32_t n) {
+    uint32_t l = left(n);
+    setLeft(n, right(l));
+    setRight(l, n);
+    setRed(l, isRed(n));
+    setRed(n, true);
+    return l;
+}
+
+///@brief flips the color of n and both of its children
+template<class DataType>
+void CompactBinTree<DataType>::flipColors(uint32_t n) {
+    nodes[n].left ^= redBit;
+    nodes[left(n)].left ^= redBit;
+    nodes[right(n)].left ^= redBit;
+}
+
+/**@brief restores the left-leaning red-black rules at n on the way back up
+   @return the index of the node now at n's place
+
+The rules: a red node is always a left child, no red node has a red child,
+and every path down passes the same number of black nodes. A red right
+child is rotated to the left, two reds in a row on the left are rotated
+into a node with two red children, and a node with two red children
+passes the red up to itself (like splitting a full node in a 2-3 tree).
+*/
+template<class DataType>
+uint32_t CompactBinTree<DataType>::fixUp(uint32_t n) {
+    if (isRed(right(n)) && !isRed(left(n)))
+        n = rotateLeft(n);
+    if (isRed(left(n)) && isRed(left(left(n))))
+        n = rotateRight(n);
+    if (isRed(left(n)) && isRed(right(n)))
+        flipColors(n);
+    return n;
+}
+
+/**@brief makes sure that n's left child or one of its children is red
+   @return the index of the node now at n's place
+
+Called before going down to the left while removing, so that the node the
+removal ends at is red (removing a red leaf keeps every path's black count).
+It borrows from the right sibling if that one has a red child to spare.
+*/
+template<class DataType>
+uint32_t CompactBinTree<DataType>::moveRedLeft(uint32_t n) {
+    flipColors(n);
+    if (isRed(left(right(n))))
+    {
+        setRight(n, rotateRight(right(n)));
+        n = rotateLeft(n);
+        flipColors(n);
+    }
+    return n;
+}
+
+///@brief the mirror image of moveRedLeft(), before going down to the right
+template<class DataType>
+uint32_t CompactBinTree<DataType>::moveRedRight(uint32_t n) {
+    flipColors(n);
+    if (isRed(left(left(n))))
+    {
+        n = rotateRight(n);
+        flipColors(n);
+    }
+    return n;
+}
+
+/**@brief adds data below n
+   @param n the subtree to add to
+   @param data the data to add
+   @param make called to get the new node once data is known to be new
+   @param found set to the node equal to data
+   @param added set to whether make was called
+   @return the index of the node now at n's place
+*/
+template<class DataType>
+template<class Make>
+uint32_t CompactBinTree<DataType>::insertAt(uint32_t n, const DataType& data,
+                                            Make& make, uint32_t& found,
+                                            bool& added) {
+    if (n == nil)
+    {
+        found = make();
+        added = true;
+        return found;
+    }
+    if (data < nodes[n].data)
+        setLeft(n, insertAt(left(n), data, make, found, added));
+    else if (nodes[n].data < data)
+        setRight(n, insertAt(right(n), data, make, found, added));
+    else
+    {
+        found = n;
+        return n;
+    }
+    return fixUp(n);
+}
+
+/**@brief removes the node equal to data below n (it must be there)
+   @return the index of the node now at n's place
+
+A node with two children is replaced by the smallest node of its right
+subtree, which is moved into its place rather than having its data copied.
+*/
+template<class DataType>
+template<class Key>
+uint32_t CompactBinTree<DataType>::removeAt(uint32_t n, const Key& data) {
+    if (data < nodes[n].data)
+    {
+        if (!isRed(left(n)) && !isRed(left(left(n))))
+            n = moveRedLeft(n);
+        setLeft(n, removeAt(left(n), data));
+        return fixUp(n);
+    }
+
+    //data >= n from here on, even after the rotations below
+    if (isRed(left(n)))
+        n = rotateRight(n);
+    if (!(nodes[n].data < data) && right(n) == nil)
+    {
+        freeNode(n);
+        return nil;
+    }
+    if (!isRed(right(n)) && !isRed(left(right(n))))
+        n = moveRedRight(n);
+    if (!(nodes[n].data < data))
+    {
+        uint32_t min;
+        uint32_t rest = removeMin(right(n), min);
+        nodes[min].left = left(n) | (nodes[n].left & redBit);
+        setRight(min, rest);
+        freeNode(n);
+        n = min;
+    }
+    else
+        setRight(n, removeAt(right(n), data));
+    return fixUp(n);
+}
+
+/**@brief unlinks the smallest node below n
+   @param min set to the index of the node that was unlinked
+   @return the index of the node now at n's place
+*/
+template<class DataType>
+uint32_t CompactBinTree<DataType>::removeMin(uint32_t n, uint32_t& min) {
+    if (left(n) == nil) //the smallest node never has a right child here
+    {
+        min = n;
+        return nil;
+    }
+    if (!isRed(left(n)) && !isRed(left(left(n))))
+        n = moveRedLeft(n);
+    setLeft(n, removeMin(left(n), min));
+    return fixUp(n);
+}
+
+/**@brief adds data to the tree in one pass, unless it is a duplicate
+   @param data the data to add, which may be in the tree's own array
+   @param make returns a new node holding data (red with no children)
+   @param found set to the node equal to data
+   @return true if make was called and its node added
+
+A free slot must be ready before calling this (see reserveSlot()), so make()
+never moves the array while the recursion holds indexes and data.
+*/
+template<class DataType>
+template<class Make>
+bool CompactBinTree<DataType>::insertNode(const DataType& data, Make make,
+                                          uint32_t& found) {
+    bool added = false;
+    root = insertAt(root, data, make, found, added);
+    setRed(root, false);
+    if (added)
+        nodeCount++;
+    return added;
+}
+
+///@brief get the height of the subtree at n
+template<class DataType>
+uint32_t CompactBinTree<DataType>::heightOf(uint32_t n) const {
+    if (n == nil)
+        return 0;
+    uint32_t l = heightOf(left(n)), r = heightOf(right(n));
+    return 1 + ((l > r) ? l : r);
+}
+
+/**@brief visits every node below (and including) n in the specified order
+   @param level n's level
+   @param visit called as visit(data, level), may return false to stop
+   @return false if visit stopped the walk early
+*/
+template<class DataType>
+template<class Visit>
+bool CompactBinTree<DataType>::walk(TreeTraverse order, uint32_t n,
+                                    uint32_t level, Visit& visit) const {
+    if (n == nil)
+        return true;
+    const DataType& data = nodes[n].data;
+    auto keepGoing = [&visit, &data, level]() {
+        if constexpr (std::is_void<decltype(visit(data, level))>::value)
+        {
+            visit(data, level);
+            return true;
+        }
+        else
+            return static_cast<bool>(visit(data, level));
+    };
+
+    if (order == PRE_ORDER && !keepGoing())
+        return false;
+    if (!walk(order, left(n), level + 1, visit))
+        return false;
+    if (order == IN_ORDER && !keepGoing())
+        return false;
+    //read before the visit, so a POST_ORDER visit may destroy the data
+    uint32_t r = right(n);
+    if (!walk(order, r, level + 1, visit))
+        return false;
+    return order != POST_ORDER || keepGoing();
+}
+
+#endif // COMPACTBINTREE_HH
@@ -0,0 +1,518 @@
+///@file ConcurrentBinTree.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef CONCURRENTBINTREE_HH
+#define CONCURRENTBINTREE_HH
+
+#include <new>
+#include <utility>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include "BinTree.hh" //for TreeTraverse
+#include "NodePool.hh"
+
+/**@brief A sorted tree that many threads can search and change at once
+
+Searches never take a lock and never wait for a writer. They also never see
+a half-finished change, because published nodes are never modified:
+
+* A writer copies the nodes on the path it changes (and any it rotates), and
+  links the copies to the untouched parts of the old tree, then publishes
+  the new root with a single atomic store. A search sees either the old tree
+  or the new one, whichever root it loaded.
+* The replaced nodes are retired, not freed, since a search may still be
+  reading them. Every search records the global epoch in a reader slot while
+  it runs, and each write advances the epoch. A retired node is freed once no
+  search that started before it was retired is still running.
+* When more than slotCount searches run at once, the extra ones share one
+  overflow counter instead of waiting for a slot. The overflow remembers the
+  oldest epoch any of them started in until they have all left, so while
+  the overflow stays busy, retired nodes pile up rather than being freed.
+* Writes are globally serialized: every insert() and remove() takes the same
+  mutex, and each one publishes a whole new root, so two writes never run
+  at once, even in unrelated subtrees. With path copying a writer only holds
+  the lock for O(log n) work, so this pays off when reads dominate. A
+  write-heavy mix (50/50, say) scales no better than a BinTree behind one
+  mutex, and bench/concurrent.cc has only been run on one CPU so far.
+
+The tree is an AVL tree, since its height (at most 1.44 lg(n)) keeps both the
+searches and the copied paths short.
+
+@tparam DataType the type of data to store, compared with <, must be copyable
+*/
+template<class DataType>
+class ConcurrentBinTree {
+private:
+    ///@brief a node that never changes once another thread can see it
+    struct CNode {
+        DataType data;
+        CNode* left;
+        CNode* right;
+        uint32_t height; ///< the number of levels in this subtree
+        CNode(const DataType& data, CNode* left, CNode* right)
+            : data(data), left(left), right(right) {}
+    };
+    ///@brief a node that was replaced, and the epoch it was replaced in
+    struct Retired {
+        CNode* n;
+        uint64_t epoch;
+    };
+    ///@brief the epoch a search started in, 0 if the slot is not in use
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch;
+    };
+
+    static const uint32_t slotCount = 128; ///< the most searches at once
+    static const size_t reclaimBatch = 256; ///< retired nodes before reclaim
+
+    std::atomic<CNode*> root;
+    std::atomic<uint32_t> nodeCount;
+    std::atomic<uint64_t> epoch; ///< advanced by every change
+    mutable ReaderSlot slots[slotCount]; ///< claimed by running searches
+    ///@brief the searches without a slot (top bits, see overflowShift), and
+    ///       the oldest epoch any of them started in (the rest)
+    mutable std::atomic<uint64_t> overflow;
+    static const uint32_t overflowShift = 44;
+
+    std::mutex writeLock; ///< held while changing the tree
+    NodePool<CNode> pool; ///< only used while holding writeLock
+    std::vector<Retired> retired; ///< oldest first, guarded by writeLock
+    std::vector<CNode*> replaced; ///< retired by the change in progress
+
+    uint32_t enter() const;
+    void leave(uint32_t slot) const;
+
+    static uint32_t heightOf(const CNode* n);
+    CNode* make(CNode* left, const DataType& data, CNode* right);
+    void retire(CNode* n);
+    void publish(CNode* newRoot);
+    void reclaim();
+    CNode* balance(CNode* left, const DataType& data, CNode* right);
+    CNode* insert(CNode* n, const DataType& data, bool& added);
+    template<class Key>
+    CNode* remove(CNode* n, const Key& data, bool& removed);
+    CNode* removeMin(CNode* n, const DataType*& min);
+    static void walk(TreeTraverse order, const CNode* n, uint32_t level,
+                     void (*func)(const DataType&, uint32_t));
+    void delNode(CNode* n);
+public:
+    ConcurrentBinTree(); ///< default constructor
+    ~ConcurrentBinTree(); ///< no other thread may use the tree any more
+    ConcurrentBinTree(const ConcurrentBinTree<DataType>&) = delete;
+    void operator=(const ConcurrentBinTree<DataType>&) = delete;
+
+    uint32_t count() const; ///< get the number of items in the tree
+    uint32_t height() const;
+    bool insert(const DataType& data);
+    template<class Key>
+    bool remove(const Key& data);
+    template<class Key>
+    const std::pair<bool, uint32_t> search(const Key& data) const;
+    template<class Key>
+    bool contains(const Key& data) const;
+    void traverse(TreeTraverse order,
+                  void (*func)(const DataType&, uint32_t)) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+template<class DataType>
+ConcurrentBinTree<DataType>::ConcurrentBinTree() {
+    root.store(NULL);
+    nodeCount.store(0);
+    epoch.store(1);
+    for (uint32_t i = 0; i < slotCount; i++)
+        slots[i].epoch.store(0);
+    overflow.store(0);
+}
+
+template<class DataType>
+ConcurrentBinTree<DataType>::~ConcurrentBinTree() {
+    for (const Retired& r : retired)
+        delNode(r.n);
+    if (!std::is_trivially_destructible<DataType>::value)
+    {
+        //destroy the data in every node before the pool is released
+        std::vector<CNode*> stack;
+        if (root.load() != NULL)
+            stack.push_back(root.load());
+        while (!stack.empty())
+        {
+            CNode* n = stack.back();
+            stack.pop_back();
+            if (n->left != NULL)
+                stack.push_back(n->left);
+            if (n->right != NULL)
+                stack.push_back(n->right);
+            delNode(n);
+        }
+    }
+    pool.release();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PUBLIC
+template<class DataType>
+uint32_t ConcurrentBinTree<DataType>::count() const {
+    return nodeCount.load(std::memory_order_relaxed);
+}
+
+template<class DataType>
+uint32_t ConcurrentBinTree<DataType>::height() const {
+    uint32_t slot = enter();
+    uint32_t h = heightOf(root.load());
+    leave(slot);
+    return h;
+}
+
+/**@brief adds data to the tree
+   @param data the data to add
+   @return false if data was already in the tree
+*/
+template<class DataType>
+bool ConcurrentBinTree<DataType>::insert(const DataType& data) {
+    std::lock_guard<std::mutex> lock(writeLock);
+    bool added = false;
+    CNode* newRoot = insert(root.load(), data, added);
+    if (added)
+    {
+        publish(newRoot);
+        nodeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    return added;
+}
+
+/**@brief removes data from the tree
+   @param data the data to remove
+   @return false if data was not in the tree
+*/
+template<class DataType>
+template<class Key>
+bool ConcurrentBinTree<DataType>::remove(const Key& data) {
+    std::lock_guard<std::mutex> lock(writeLock);
+    bool removed = false;
+    CNode* newRoot = remove(root.load(), data, removed);
+    if (removed)
+    {
+        publish(newRoot);
+        nodeCount.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return removed;
+}
+
+/**@brief searches the tree without locking
+   @param data the data to search for
+   @return an std::pair<bool, uint32_t> of whether the data exists and the
+           level that it is on
+*/
+template<class DataType>
+template<class Key>
+const std::pair<bool, uint32_t>
+ConcurrentBinTree<DataType>::search(const Key& data) const {
+    uint32_t slot = enter();
+    const CNode* n = root.load();
+    uint32_t level = 0;
+    while (n != NULL)
+    {
+        if (data < n->data)
+            n = n->left;
+        else if (n->data < data)
+            n = n->right;
+        else
+            break;
+        level++;
+    }
+    leave(slot);
+    if (n == NULL)
+        return std::make_pair(false, 0);
+    return std::make_pair(true, level);
+}
+
+///@brief checks if data is in the tree, without locking
+template<class DataType>
+template<class Key>
+bool ConcurrentBinTree<DataType>::contains(const Key& data) const {
+    return search(data).first;
+}
+
+/**@brief runs a user-supplied function on every item in the tree
+
+The walk sees the tree as it was when the walk started, changes made while it
+runs are not visited. Nodes stay allocated until the walk is done.
+*/
+template<class DataType>
+void ConcurrentBinTree<DataType>::traverse(TreeTraverse order,
+                        void (*func)(const DataType&, uint32_t)) const {
+    uint32_t slot = enter();
+    walk(order, root.load(), 0, func);
+    leave(slot);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+/**@brief marks the start of a search
+   @return the reader slot to give to leave(), slotCount for the overflow
+
+The slot records the epoch the search started in, which keeps every node that
+is retired in that epoch (or later) from being freed. Each thread starts
+looking at its own slot, so slots are almost never contended. If every slot
+is taken, the search joins the overflow instead of waiting. The count and
+the epoch share one word, so joining (and leaving) changes both at once and
+reclaim() can never see one without the other.
+*/
+template<class DataType>
+uint32_t ConcurrentBinTree<DataType>::enter() const {
+    static std::atomic<uint32_t> nextThread(0);
+    static thread_local uint32_t home = nextThread.fetch_add(1);
+
+    for (uint32_t i = home; i < home + slotCount; i++)
+    {
+        uint32_t slot = i % slotCount;
+        uint64_t idle = 0;
+        if (slots[slot].epoch.load(std::memory_order_relaxed) == 0 &&
+            slots[slot].epoch.compare_exchange_strong(idle, epoch.load()))
+            return slot;
+    }
+
+    const uint64_t one = static_cast<uint64_t>(1) << overflowShift;
+    const uint64_t e = epoch.load();
+    uint64_t old = overflow.load();
+    uint64_t joined;
+    do
+    {
+        //the first search in sets the epoch, the others can only lower it
+        uint64_t pinned = old & (one - 1);
+        if (old < one || e < pinned)
+            pinned = e;
+        joined = ((old >> overflowShift) + 1) << overflowShift | pinned;
+    } while (!overflow.compare_exchange_weak(old, joined));
+    return slotCount;
+}
+
+///@brief marks the end of a search, its nodes may now be freed
+template<class DataType>
+void ConcurrentBinTree<DataType>::leave(uint32_t slot) const {
+    if (slot == slotCount)
+        overflow.fetch_sub(static_cast<uint64_t>(1) << overflowShift,
+                           std::memory_order_release);
+    else
+        slots[slot].epoch.store(0, std::memory_order_release);
+}
+
+template<class DataType>
+uint32_t ConcurrentBinTree<DataType>::heightOf(const CNode* n) {
+    return (n == NULL) ? 0 : n->height;
+}
+
+///@brief makes a new, unpublished node
+template<class DataType>
+typename ConcurrentBinTree<DataType>::CNode*
+ConcurrentBinTree<DataType>::make(CNode* left, const DataType& data,
+                                  CNode* right) {
+    CNode* n = new (pool.allocate()) CNode(data, left, right);
+    uint32_t l = heightOf(left), r = heightOf(right);
+    n->height = 1 + (l > r ? l : r);
+    return n;
+}
+
+///@brief records that a node is no longer part of the tree being built
+template<class DataType>
+void ConcurrentBinTree<DataType>::retire(CNode* n) {
+    replaced.push_back(n);
+}
+
+/**@brief makes a new tree visible to searches
+
+Everything written to the new nodes happens before the root store, so a
+search that loads the new root sees them complete. The nodes that the change
+replaced are tagged with the epoch before it is advanced: only searches that
+started in that epoch (or earlier) can still be reading them.
+*/
+template<class DataType>
+void ConcurrentBinTree<DataType>::publish(CNode* newRoot) {
+    root.store(newRoot);
+    uint64_t e = epoch.fetch_add(1);
+    for (CNode* n : replaced)
+        retired.push_back(Retired{n, e});
+    replaced.clear();
+    if (retired.size() >= reclaimBatch)
+        reclaim();
+}
+
+///@brief frees the retired nodes that no running search can reach
+template<class DataType>
+void ConcurrentBinTree<DataType>::reclaim() {
+    uint64_t oldest = epoch.load();
+    for (uint32_t i = 0; i < slotCount; i++)
+    {
+        uint64_t e = slots[i].epoch.load();
+        if (e != 0 && e < oldest)
+            oldest = e;
+    }
+    uint64_t o = overflow.load();
+    if (o >> overflowShift != 0)
+    {
+        uint64_t e = o & ((static_cast<uint64_t>(1) << overflowShift) - 1);
+        if (e < oldest)
+            oldest = e;
+    }
+
+    //retired is in epoch order, free from the front
+    size_t freed = 0;
+    while (freed < retired.size() && retired[freed].epoch < oldest)
+        delNode(retired[freed++].n);
+    retired.erase(retired.begin(), retired.begin() + freed);
+}
+
+/**@brief joins two subtrees under data, rotating if they are out of balance
+   @return the new subtree, any node that it does not use is retired
+
+The heights of left and right differ by at most 2 (as after an AVL insert or
+remove), and the rotations make new nodes rather than relinking old ones.
+*/
+template<class DataType>
+typename ConcurrentBinTree<DataType>::CNode*
+ConcurrentBinTree<DataType>::balance(CNode* left, const DataType& data,
+                                     CNode* right) {
+    uint32_t l = heightOf(left), r = heightOf(right);
+    if (l > r + 1)
+    {
+        retire(left);
+        if (heightOf(left->left) >= heightOf(left->right)) //single rotation
+            return make(left->left, left->data,
+                        make(left->right, data, right));
+        CNode* mid = left->right; //double rotation
+        retire(mid);
+        return make(make(left->left, left->data, mid->left), mid->data,
+                    make(mid->right, data, right));
+    }
+    if (r > l + 1)
+    {
+        retire(right);
+        if (heightOf(right->right) >= heightOf(right->left))
+            return make(make(left, data, right->left), right->data,
+                        right->right);
+        CNode* mid = right->left;
+        retire(mid);
+        return make(make(left, data, mid->left), mid->data,
+                    make(mid->right, right->data, right->right));
+    }
+    return make(left, data, right);
+}
+
+/**@brief copies the path to where data belongs, with data added
+   @param n the subtree to add data to
+   @param data the data to add
+   @param added set to false if data is a duplicate
+   @return the new subtree (n itself if nothing changed)
+*/
+template<class DataType>
+typename ConcurrentBinTree<DataType>::CNode*
+ConcurrentBinTree<DataType>::insert(CNode* n, const DataType& data,
+                                    bool& added) {
+    if (n == NULL)
+    {
+        added = true;
+        return make(NULL, data, NULL);
+    }
+    if (data < n->data)
+    {
+        CNode* left = insert(n->left, data, added);
+        if (!added)
+            return n;
+        retire(n);
+        return balance(left, n->data, n->right);
+    }
+    if (n->data < data)
+    {
+        CNode* right = insert(n->right, data, added);
+        if (!added)
+            return n;
+        retire(n);
+        return balance(n->left, n->data, right);
+    }
+    return n;
+}
+
+///@brief copies the path to data, without data, see insert()
+template<class DataType>
+template<class Key>
+typename ConcurrentBinTree<DataType>::CNode*
+ConcurrentBinTree<DataType>::remove(CNode* n, const Key& data,
+                                    bool& removed) {
+    if (n == NULL)
+        return NULL;
+    if (data < n->data)
+    {
+        CNode* left = remove(n->left, data, removed);
+        if (!removed)
+            return n;
+        retire(n);
+        return balance(left, n->data, n->right);
+    }
+    if (n->data < data)
+    {
+        CNode* right = remove(n->right, data, removed);
+        if (!removed)
+            return n;
+        retire(n);
+        return balance(n->left, n->data, right);
+    }
+
+    removed = true;
+    retire(n);
+    if (n->left == NULL)
+        return n->right;
+    if (n->right == NULL)
+        return n->left;
+    //the successor takes n's place
+    const DataType* min;
+    CNode* right = removeMin(n->right, min);
+    return balance(n->left, *min, right);
+}
+
+/**@brief copies the path to the smallest item, without it
+   @param min set to the smallest item, it stays valid until the next publish
+*/
+template<class DataType>
+typename ConcurrentBinTree<DataType>::CNode*
+ConcurrentBinTree<DataType>::removeMin(CNode* n, const DataType*& min) {
+    retire(n);
+    if (n->left == NULL)
+    {
+        min = &n->data;
+        return n->right;
+    }
+    CNode* left = removeMin(n->left, min);
+    return balance(left, n->data, n->right);
+}
+
+template<class DataType>
+void ConcurrentBinTree<DataType>::walk(TreeTraverse order, const CNode* n,
+                                       uint32_t level,
+                                       void (*func)(const DataType&,
+                                                    uint32_t)) {
+    if (n == NULL)
+        return;
+    if (order == PRE_ORDER)
+        func(n->data, level);
+    walk(order, n->left, level + 1, func);
+    if (order == IN_ORDER)
+        func(n->data, level);
+    walk(order, n->right, level + 1, func);
+    if (order == POST_ORDER)
+        func(n->data, level);
+}
+
+///@brief destroys a single node and returns it to the pool
+template<class DataType>
+void ConcurrentBinTree<DataType>::delNode(CNode* n) {
+    n->~CNode();
+    pool.deallocate(n);
+}
+
+#endif // CONCURRENTBINTREE_HH
@@ -0,0 +1,263 @@
+///@file FrozenBinTree.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef FROZENBINTREE_HH
+#define FROZENBINTREE_HH
+
+#include <new>
+#include <utility>
+#include <iterator>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**@brief An immutable, pointer-free copy of a sorted tree (BinTree::freeze())
+
+The items are stored in a single array in Eytzinger order: the array is a
+complete binary tree laid out level by level, like a binary heap. The root is
+at [1], and the children of [k] are at [2k] and [2k + 1], so there are no
+pointers to store or follow.
+
+* Memory use is sizeof(DataType) per item, a Node<uint64_t> takes 40 bytes to
+  hold 8 bytes of data
+* A search is a loop of k = 2k + (item < key), with no branch to mispredict
+* The first few levels of the tree are shared by every search, so they stay
+  in the cache. Further down, the 2^d descendants of [k] that are d levels
+  below it sit next to each other (at [k * 2^d]), so one cache line holds
+  several levels: the search prefetches that line while it works its way
+  down to it.
+* Nothing changes after construction, so any number of threads can search at
+  the same time without locking
+
+@tparam DataType the type of data to store, compared with <
+*/
+template<class DataType>
+class FrozenBinTree {
+private:
+    static const size_t lineSize = 64; ///< the size of a cache line
+    ///the number of items in a cache line, how far ahead to prefetch
+    static const size_t lineItems = (sizeof(DataType) < lineSize)
+                                    ? lineSize / sizeof(DataType) : 1;
+
+    DataType* items; ///< [1] through [itemCount], [0] is not used
+    uint32_t itemCount;
+
+    void allocate(uint32_t size);
+    void destroy();
+    template<class Key>
+    size_t lowerIndex(const Key& data) const;
+public:
+    FrozenBinTree(); ///< default constructor, an empty tree
+    template<class Iter>
+    FrozenBinTree(Iter first, Iter last);
+    ~FrozenBinTree();
+    uint32_t count() const; ///< get the number of items
+    uint32_t height() const; ///< get the number of levels
+    size_t memory() const; ///< get the number of bytes used by the items
+    template<class Key>
+    const std::pair<bool, uint32_t> search(const Key& data) const;
+    template<class Key>
+    bool contains(const Key& data) const;
+    template<class Key>
+    const DataType* lower_bound(const Key& data) const;
+    FrozenBinTree(const FrozenBinTree<DataType>& source);
+    FrozenBinTree(FrozenBinTree<DataType>&& source);
+    FrozenBinTree<DataType>& operator=(const FrozenBinTree<DataType>& right);
+    FrozenBinTree<DataType>& operator=(FrozenBinTree<DataType>&& right);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+template<class DataType>
+FrozenBinTree<DataType>::FrozenBinTree() {
+    items = NULL;
+    itemCount = 0;
+}
+
+/**@brief builds the array from sorted data
+   @param first the smallest item
+   @param last the position after the largest item
+
+The slots are filled in the order an in-order walk visits them, which puts
+the data in search order. The walk moves from slot to slot by index alone:
+right child then all the way left, or else up past every right turn.
+*/
+template<class DataType>
+template<class Iter>
+FrozenBinTree<DataType>::FrozenBinTree(Iter first, Iter last) {
+    items = NULL;
+    itemCount = 0;
+    allocate(std::distance(first, last));
+
+    size_t n = itemCount;
+    size_t k = 1;
+    while (2 * k <= n)
+        k *= 2;
+    for (; first != last; ++first)
+    {
+        new (&items[k]) DataType(*first);
+        if (2 * k + 1 <= n)
+        {
+            k = 2 * k + 1;
+            while (2 * k <= n)
+                k *= 2;
+        }
+        else
+        {
+            while (k & 1)
+                k >>= 1;
+            k >>= 1;
+        }
+    }
+}
+
+template<class DataType>
+FrozenBinTree<DataType>::~FrozenBinTree() {
+    destroy();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PUBLIC
+template<class DataType>
+uint32_t FrozenBinTree<DataType>::count() const {
+    return itemCount;
+}
+
+template<class DataType>
+uint32_t FrozenBinTree<DataType>::height() const {
+    uint32_t levels = 0;
+    for (size_t k = itemCount; k > 0; k >>= 1)
+        levels++;
+    return levels;
+}
+
+template<class DataType>
+size_t FrozenBinTree<DataType>::memory() const {
+    return (itemCount == 0) ? 0 : (itemCount + 1) * sizeof(DataType);
+}
+
+/**@brief searches the tree, safe to call from many threads at once
+   @param data the data to search for
+   @return an std::pair<bool, uint32_t> of whether the data exists and the
+           level that it is on
+*/
+template<class DataType>
+template<class Key>
+const std::pair<bool, uint32_t>
+FrozenBinTree<DataType>::search(const Key& data) const {
+    size_t k = lowerIndex(data);
+    if (k == 0 || data < items[k])
+        return std::make_pair(false, 0);
+
+    uint32_t level = 0;
+    while (k > 1)
+    {
+        k >>= 1;
+        level++;
+    }
+    return std::make_pair(true, level);
+}
+
+///@brief checks if data is in the tree
+template<class DataType>
+template<class Key>
+bool FrozenBinTree<DataType>::contains(const Key& data) const {
+    size_t k = lowerIndex(data);
+    return k != 0 && !(data < items[k]);
+}
+
+///@brief finds the smallest item >= data, NULL if there is none
+template<class DataType>
+template<class Key>
+const DataType* FrozenBinTree<DataType>::lower_bound(const Key& data) const {
+    size_t k = lowerIndex(data);
+    return (k == 0) ? NULL : &items[k];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//COPY
+template<class DataType>
+FrozenBinTree<DataType>::FrozenBinTree(const FrozenBinTree<DataType>& source) {
+    items = NULL;
+    itemCount = 0;
+    *this = source;
+}
+
+template<class DataType>
+FrozenBinTree<DataType>::FrozenBinTree(FrozenBinTree<DataType>&& source) {
+    items = source.items;
+    itemCount = source.itemCount;
+    source.items = NULL;
+    source.itemCount = 0;
+}
+
+template<class DataType>
+FrozenBinTree<DataType>&
+FrozenBinTree<DataType>::operator=(const FrozenBinTree<DataType>& right) {
+    if (this == &right)
+        return *this;
+    destroy();
+    allocate(right.itemCount);
+    std::uninitialized_copy(right.items + 1, right.items + 1 + itemCount,
+                            items + 1);
+    return *this;
+}
+
+template<class DataType>
+FrozenBinTree<DataType>&
+FrozenBinTree<DataType>::operator=(FrozenBinTree<DataType>&& right) {
+    std::swap(items, right.items);
+    std::swap(itemCount, right.itemCount);
+    return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+/**@brief gets uninitialized, cache-line aligned space for size items
+
+Aligning [0] also aligns [k * lineItems], the first of the descendants that
+lowerIndex() prefetches, so each prefetch fetches exactly one line.
+*/
+template<class DataType>
+void FrozenBinTree<DataType>::allocate(uint32_t size) {
+    itemCount = size;
+    if (size == 0)
+        return;
+    items = static_cast<DataType*>(::operator new(
+        (size + 1) * sizeof(DataType), std::align_val_t(lineSize)));
+}
+
+///@brief destroys every item and frees the array
+template<class DataType>
+void FrozenBinTree<DataType>::destroy() {
+    if (items == NULL)
+        return;
+    for (size_t k = 1; k <= itemCount; k++)
+        items[k].~DataType();
+    ::operator delete(items, std::align_val_t(lineSize));
+    items = NULL;
+    itemCount = 0;
+}
+
+/**@brief finds the slot of the smallest item >= data
+   @return the slot, 0 if every item is smaller than data
+
+Every step goes left or right by adding the result of the comparison, so the
+loop has no data-dependent branches, just a fixed number of steps (the
+height). When it falls off the bottom, the bits of k record the path: each 1
+is a right turn. The answer is the last place the search turned left, found
+by dropping the trailing right turns and that one left turn.
+*/
+template<class DataType>
+template<class Key>
+size_t FrozenBinTree<DataType>::lowerIndex(const Key& data) const {
+    size_t k = 1;
+    while (k <= itemCount)
+    {
+        __builtin_prefetch(items + k * lineItems);
+        k = 2 * k + (items[k] < data);
+    }
+    return k >> (__builtin_ctzll(~static_cast<unsigned long long>(k)) + 1);
+}
+
+#endif // FROZENBINTREE_HH
@@ -0,0 +1,409 @@
+///@file MappedBinTree.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef MAPPEDBINTREE_HH
+#define MAPPEDBINTREE_HH
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <type_traits>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "BinTree.hh"
+
+/**@brief The start of a tree file (see saveTree())
+
+Tree files need POSIX (for mmap), so they live in this header rather than
+in BinTree.hh. Include it to save, load or map a tree.
+
+A tree file holds the items of a tree in ascending order, so loading it never
+has to sort or compare anything to rebuild the tree.
+
+* Fixed-size items (anything trivially copyable: numbers, plain structs) are
+  stored as a plain array right after the header, exactly as they are in
+  memory. The file only makes sense on machines with the same byte order.
+* Strings are stored as a table of count + 1 offsets (uint64_t, from the end
+  of the table), followed by one blob per string: a uint32_t length and then
+  the characters. The table gives O(1) access to any string, so the file can
+  be binary searched while it is mapped.
+*/
+struct TreeFileHeader {
+    char magic[8];       ///< "BINTREE", to recognize the file
+    uint32_t version;    ///< treeFileVersion
+    uint32_t recordSize; ///< sizeof(DataType) for fixed-size items, else 0
+    uint64_t count;      ///< the number of items
+    uint64_t bytes;      ///< the size of everything after the header
+};
+
+const uint32_t treeFileVersion = 1;
+
+/**@brief How one type of item is written to and read from a tree file
+
+Only fixed-size types and std::string can be saved, any other type is a
+compile error.
+*/
+template<class DataType, class Enable = void>
+struct TreeRecord;
+
+///@brief fixed-size items, stored as an array
+template<class DataType>
+struct TreeRecord<DataType, typename std::enable_if<
+                      std::is_trivially_copyable<DataType>::value>::type> {
+    static const uint32_t size = sizeof(DataType);
+    typedef const DataType& View; ///< what reading a mapped item gives
+
+    ///@brief writes the items after the header, false if writing failed
+    template<class Iter>
+    static bool write(FILE* file, Iter first, Iter last) {
+        for (; first != last; ++first)
+        {
+            if (fwrite(&*first, sizeof(DataType), 1, file) != 1)
+                return false;
+        }
+        return true;
+    }
+    ///@brief the number of bytes the items take, after the header
+    template<class Iter>
+    static uint64_t bytes(Iter first, Iter last, uint64_t count) {
+        return count * sizeof(DataType);
+    }
+    ///@brief checks that the mapped items fit in the file
+    static bool valid(const char* data, uint64_t bytes, uint64_t count) {
+        return bytes == count * sizeof(DataType);
+    }
+    ///@brief gets item i, which valid() has already checked
+    static View read(const char* data, uint64_t bytes, uint64_t count,
+                     uint64_t i) {
+        return reinterpret_cast<const DataType*>(data)[i];
+    }
+};
+
+///@brief strings, stored as an offset table and length-prefixed blobs
+template<>
+struct TreeRecord<std::string> {
+    static const uint32_t size = 0;
+    typedef std::string_view View;
+
+    template<class Iter>
+    static bool write(FILE* file, Iter first, Iter last) {
+        uint64_t offset = 0;
+        for (Iter i = first; i != last; ++i)
+        {
+            if (fwrite(&offset, sizeof(offset), 1, file) != 1)
+                return false;
+            offset += sizeof(uint32_t) + i->size();
+        }
+        if (fwrite(&offset, sizeof(offset), 1, file) != 1)
+            return false;
+        for (; first != last; ++first)
+        {
+            uint32_t length = first->size();
+            if (fwrite(&length, sizeof(length), 1, file) != 1 ||
+                fwrite(first->data(), 1, length, file) != length)
+                return false;
+        }
+        return true;
+    }
+    template<class Iter>
+    static uint64_t bytes(Iter first, Iter last, uint64_t count) {
+        uint64_t total = (count + 1) * sizeof(uint64_t);
+        for (; first != last; ++first)
+            total += sizeof(uint32_t) + first->size();
+        return total;
+    }
+    /**@brief checks that the offset table fits in the file, and its two
+              ends
+
+    Only the first and last offsets are read, so opening a file does not
+    touch the pages in between. Every other offset and length is checked by
+    read(), when a search gets to it.
+    */
+    static bool valid(const char* data, uint64_t bytes, uint64_t count) {
+        if (count >= bytes / sizeof(uint64_t)) //the table would not fit
+            return false;
+        const uint64_t table = (count + 1) * sizeof(uint64_t);
+        const uint64_t* offsets = reinterpret_cast<const uint64_t*>(data);
+        return offsets[0] == 0 && offsets[count] == bytes - table;
+    }
+    /**@brief gets string i, checking its offset and length first
+       @return the string, or an empty view if its offset or length would
+               run past the end of the file (a damaged file)
+    */
+    static View read(const char* data, uint64_t bytes, uint64_t count,
+                     uint64_t i) {
+        const uint64_t table = (count + 1) * sizeof(uint64_t);
+        const uint64_t blobs = bytes - table; //checked by valid()
+        const uint64_t offset = reinterpret_cast<const uint64_t*>(data)[i];
+        uint32_t length;
+        if (offset > blobs || blobs - offset < sizeof(length))
+            return View();
+        const char* blob = data + table + offset;
+        memcpy(&length, blob, sizeof(length));
+        if (length > blobs - offset - sizeof(length))
+            return View();
+        return View(blob + sizeof(length), length);
+    }
+};
+
+/**@brief writes sorted items to a tree file
+   @param path the file to write, replaced if it exists
+   @param first the smallest item
+   @param last the position after the largest item
+   @param count the number of items from first to last
+   @return false if the file could not be written
+*/
+template<class DataType, class Iter>
+bool saveTree(const char* path, Iter first, Iter last, uint64_t count) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+        return false;
+
+    TreeFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "BINTREE", 8);
+    header.version = treeFileVersion;
+    header.recordSize = TreeRecord<DataType>::size;
+    header.count = count;
+    header.bytes = TreeRecord<DataType>::bytes(first, last, count);
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              TreeRecord<DataType>::write(file, first, last);
+    return (fclose(file) == 0) && ok;
+}
+
+/**@brief A read-only tree served straight from a memory-mapped tree file
+
+Opening the file maps it into memory and checks the header, nothing is
+copied or allocated. Pages are read from disk the first time a search
+touches them, so the first lookups can start right away, and processes
+that map the same file share one copy of it in the page cache. For strings,
+each offset and length is only checked when it is read (see TreeRecord), so
+a damaged entry reads as an empty string instead of failing open().
+
+Searches are binary searches over the sorted items (O(log n)). Items are
+read as TreeRecord<DataType>::View: a const reference for fixed-size types,
+a std::string_view for strings.
+*/
+template<class DataType>
+class MappedBinTree {
+private:
+    typedef TreeRecord<DataType> Record;
+    char* map; ///< the whole file
+    size_t mapSize;
+    const char* data; ///< the items, right after the header
+    uint64_t itemCount;
+    uint64_t dataBytes;
+public:
+    typedef typename Record::View View;
+
+    MappedBinTree(); ///< default constructor, no file open
+    ~MappedBinTree();
+    MappedBinTree(const MappedBinTree<DataType>&) = delete;
+    void operator=(const MappedBinTree<DataType>&) = delete;
+
+    bool open(const char* path);
+    void close(); ///< unmaps the file
+    bool isOpen() const;
+    uint32_t count() const; ///< get the number of items
+    View operator[](uint32_t i) const; ///< get the i-th smallest item
+    template<class Key>
+    uint32_t lower_bound(const Key& data) const;
+    template<class Key>
+    uint32_t find(const Key& data) const;
+    template<class Key>
+    bool contains(const Key& data) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+template<class DataType>
+MappedBinTree<DataType>::MappedBinTree() {
+    map = NULL;
+    mapSize = 0;
+    data = NULL;
+    itemCount = 0;
+    dataBytes = 0;
+}
+
+template<class DataType>
+MappedBinTree<DataType>::~MappedBinTree() {
+    close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PUBLIC
+/**@brief maps a tree file written by saveTree()
+   @param path the file to open
+   @return false if the file can not be read, or is not a tree file of
+           DataType (another open file is closed either way)
+*/
+template<class DataType>
+bool MappedBinTree<DataType>::open(const char* path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 ||
+        static_cast<size_t>(info.st_size) < sizeof(TreeFileHeader))
+    {
+        ::close(fd);
+        return false;
+    }
+    mapSize = info.st_size;
+    void* mem = mmap(NULL, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); //the mapping stays valid
+    if (mem == MAP_FAILED)
+    {
+        mapSize = 0;
+        return false;
+    }
+    map = static_cast<char*>(mem);
+
+    TreeFileHeader header;
+    memcpy(&header, map, sizeof(header));
+    data = map + sizeof(header);
+    itemCount = header.count;
+    dataBytes = header.bytes;
+    if (memcmp(header.magic, "BINTREE", 8) != 0 ||
+        header.version != treeFileVersion ||
+        header.recordSize != Record::size ||
+        header.count > UINT32_MAX ||
+        header.bytes != mapSize - sizeof(header) ||
+        !Record::valid(data, dataBytes, itemCount))
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+template<class DataType>
+void MappedBinTree<DataType>::close() {
+    if (map != NULL)
+        munmap(map, mapSize);
+    map = NULL;
+    mapSize = 0;
+    data = NULL;
+    itemCount = 0;
+    dataBytes = 0;
+}
+
+template<class DataType>
+bool MappedBinTree<DataType>::isOpen() const {
+    return map != NULL;
+}
+
+template<class DataType>
+uint32_t MappedBinTree<DataType>::count() const {
+    return itemCount;
+}
+
+template<class DataType>
+typename MappedBinTree<DataType>::View
+MappedBinTree<DataType>::operator[](uint32_t i) const {
+    return Record::read(data, dataBytes, itemCount, i);
+}
+
+/**@brief finds the position of the smallest item >= data
+   @return the position, count() if every item is smaller than data
+*/
+template<class DataType>
+template<class Key>
+uint32_t MappedBinTree<DataType>::lower_bound(const Key& data) const {
+    uint32_t first = 0, size = itemCount;
+    while (size > 0)
+    {
+        uint32_t half = size / 2;
+        if ((*this)[first + half] < data)
+        {
+            first += half + 1;
+            size -= half + 1;
+        }
+        else
+            size = half;
+    }
+    return first;
+}
+
+///@brief finds the position of data, count() if it does not exist
+template<class DataType>
+template<class Key>
+uint32_t MappedBinTree<DataType>::find(const Key& data) const {
+    uint32_t i = lower_bound(data);
+    if (i == itemCount || data < (*this)[i])
+        return itemCount;
+    return i;
+}
+
+template<class DataType>
+template<class Key>
+bool MappedBinTree<DataType>::contains(const Key& data) const {
+    return find(data) != itemCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//BINTREE
+/**@brief writes the items of a tree to a tree file, in ascending order
+   @param path the file to write, replaced if it exists
+   @param tree the tree to save
+   @return false if the file could not be written
+
+DataType must be a fixed-size (trivially copyable) type or std::string, see
+TreeFileHeader for the format. The file can be read back with loadTree(), or
+searched in place with a MappedBinTree.
+*/
+template<class DataType>
+bool saveTree(const char* path, const BinTree<DataType>& tree) {
+    return saveTree<DataType>(path, tree.begin(), tree.end(), tree.count());
+}
+
+/**@brief replaces the contents of a tree with a file written by saveTree()
+   @param path the file to read
+   @param tree the tree to fill, it keeps its balancing scheme
+   @return false if the file can not be read or is not a valid tree file,
+           the tree is not changed in that case
+
+The file is memory-mapped, and since the items are already sorted the tree is
+built directly in balanced form with BinTree::build(), without rotating
+anything: O(n) instead of the O(n log n) of inserting every item (the items
+are only compared to make sure they are in order). Fixed-size items are
+copied straight out of the mapping into the nodes.
+*/
+template<class DataType>
+bool loadTree(const char* path, BinTree<DataType>& tree) {
+    MappedBinTree<DataType> file;
+    if (!file.open(path))
+        return false;
+    for (uint32_t i = 1; i < file.count(); i++)
+    {
+        if (!(file[i - 1] < file[i])) //not sorted, not from saveTree()
+            return false;
+    }
+
+    if constexpr (std::is_reference<
+                      typename MappedBinTree<DataType>::View>::value)
+    {
+        const DataType* items = file.count() == 0 ? NULL : &file[0];
+        tree.build(items, items + file.count());
+    }
+    else
+    {
+        std::vector<DataType> decoded;
+        decoded.reserve(file.count());
+        for (uint32_t i = 0; i < file.count(); i++)
+            decoded.emplace_back(file[i]);
+        tree.build(decoded.begin(), decoded.end());
+    }
+    return true;
+}
+
+#endif // MAPPEDBINTREE_HH
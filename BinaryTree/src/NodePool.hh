@@ -0,0 +1,187 @@
+///@file NodePool.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef NODEPOOL_HH
+#define NODEPOOL_HH
+
+#include <new>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/**@brief A slab allocator for fixed-size objects (tree nodes)
+
+Memory is taken from the system in slabs, each holding many objects. New
+objects are handed out from the end of the newest slab, and freed objects are
+kept on a freelist to be reused by the next allocate(). release() gives every
+slab back at once, without visiting the objects in them.
+
+* Slabs start at firstSlab objects and double in size up to maxSlab objects,
+  so small pools stay small and big pools make few system allocations
+* Objects allocated one after another sit next to each other in memory, which
+  helps the cache when they are visited in the same order later
+* The pool only manages memory, constructing and destroying the objects is up
+  to the caller (see BinTree::newNode())
+*/
+template<class T>
+class NodePool {
+private:
+    ///@brief the start of every slab, the objects follow it
+    struct Slab {
+        Slab* next;
+        size_t capacity; ///< the number of objects the slab can hold
+    };
+    ///@brief what a freed object turns into while it is on the freelist
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    static const size_t firstSlab = 64;
+    static const size_t maxSlab = 65536;
+    ///the first object in a slab starts here, rounded up for alignment
+    static const size_t slabHeader =
+        (sizeof(Slab) + alignof(T) - 1) / alignof(T) * alignof(T);
+
+    Slab* slabs;        ///< the newest slab, links to the older ones
+    FreeSlot* freeList; ///< objects that were freed and can be reused
+    T* next;            ///< the next unused object in the newest slab
+    T* end;             ///< one past the last object in the newest slab
+    size_t live;        ///< the number of objects currently allocated
+    size_t reserved;    ///< the number of objects all the slabs can hold
+
+    void grow();
+public:
+    NodePool();
+    ~NodePool();
+    NodePool(const NodePool<T>&) = delete; ///< pools own their memory
+    void operator=(const NodePool<T>&) = delete;
+
+    T* allocate();
+    void deallocate(T* p);
+    void release();
+    void swap(NodePool<T>& other);
+    size_t size() const; ///< get the number of objects in use
+    size_t capacity() const; ///< get the number of objects the slabs can hold
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+template<class T>
+NodePool<T>::NodePool() {
+    static_assert(sizeof(T) >= sizeof(FreeSlot),
+                  "NodePool objects must be able to hold a pointer");
+    slabs = NULL;
+    freeList = NULL;
+    next = NULL;
+    end = NULL;
+    live = 0;
+    reserved = 0;
+}
+
+template<class T>
+NodePool<T>::~NodePool() {
+    release();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PUBLIC
+
+/**@brief get memory for one object
+   @return uninitialized memory for a T, construct it with placement new
+
+Reuses the most recently freed object if there is one, since it is the most
+likely to still be in the cache.
+*/
+template<class T>
+T* NodePool<T>::allocate() {
+    T* p;
+    if (freeList != NULL)
+    {
+        p = reinterpret_cast<T*>(freeList);
+        freeList = freeList->next;
+    }
+    else
+    {
+        if (next == end)
+            grow();
+        p = next++;
+    }
+    live++;
+    return p;
+}
+
+/**@brief give back the memory of one object
+   @param p an object from allocate(), it must already be destroyed
+*/
+template<class T>
+void NodePool<T>::deallocate(T* p) {
+    FreeSlot* slot = reinterpret_cast<FreeSlot*>(p);
+    slot->next = freeList;
+    freeList = slot;
+    live--;
+}
+
+/**@brief frees every slab at once
+
+Every pointer from allocate() becomes invalid. The objects are not destroyed,
+so this is only a complete cleanup for objects with trivial destructors (or
+ones that were destroyed already).
+*/
+template<class T>
+void NodePool<T>::release() {
+    while (slabs != NULL)
+    {
+        Slab* old = slabs;
+        slabs = slabs->next;
+        ::operator delete(old);
+    }
+    freeList = NULL;
+    next = NULL;
+    end = NULL;
+    live = 0;
+    reserved = 0;
+}
+
+///@brief trades every slab (and the objects in them) with another pool
+template<class T>
+void NodePool<T>::swap(NodePool<T>& other) {
+    std::swap(slabs, other.slabs);
+    std::swap(freeList, other.freeList);
+    std::swap(next, other.next);
+    std::swap(end, other.end);
+    std::swap(live, other.live);
+    std::swap(reserved, other.reserved);
+}
+
+template<class T>
+size_t NodePool<T>::size() const {
+    return live;
+}
+
+template<class T>
+size_t NodePool<T>::capacity() const {
+    return reserved;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+///@brief adds a new slab, twice the size of the last one (up to maxSlab)
+template<class T>
+void NodePool<T>::grow() {
+    size_t count = (slabs == NULL) ? firstSlab : slabs->capacity * 2;
+    if (count > maxSlab)
+        count = maxSlab;
+
+    char* mem = static_cast<char*>(::operator new(slabHeader +
+                                                  count * sizeof(T)));
+    Slab* slab = reinterpret_cast<Slab*>(mem);
+    slab->next = slabs;
+    slab->capacity = count;
+    slabs = slab;
+
+    next = reinterpret_cast<T*>(mem + slabHeader);
+    end = next + count;
+    reserved += count;
+}
+
+#endif // NODEPOOL_HH
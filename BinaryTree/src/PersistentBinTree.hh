@@ -0,0 +1,458 @@
+///@file PersistentBinTree.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef PERSISTENTBINTREE_HH
+#define PERSISTENTBINTREE_HH
+
+#include <utility>
+#include <vector>
+#include <atomic>
+#include <initializer_list>
+#include <cstdint>
+#include <cstddef>
+#include "BinTree.hh" //for TreeTraverse
+
+/**@brief A sorted tree with O(1) copies (snapshots) that share their nodes
+
+Nodes are never changed once they are built, so any number of trees can
+share them. Copying a tree just shares its root, and a change copies only the
+O(log n) nodes on the path it touches (path copying): the copies point to
+the same untouched subtrees as the originals. Every other tree sharing the
+old nodes keeps seeing exactly what it saw before.
+
+* Every node counts the trees and nodes that point to it. A node is freed
+  when its count reaches 0, along with any children only it pointed to.
+* The counts are atomic, so snapshots can be handed to other threads and
+  read (or changed, or destroyed) there while the original keeps changing.
+  A single PersistentBinTree object is not thread safe, each thread needs
+  its own copy.
+* The tree is an AVL tree (height at most 1.44 lg(n)), which keeps the copied
+  paths short
+* Nodes come from new and delete rather than a NodePool, since the last
+  tree to drop a node may be on any thread
+
+@tparam DataType the type of data to store, compared with <, must be copyable
+*/
+template<class DataType>
+class PersistentBinTree {
+private:
+    ///@brief a node that never changes once it is built
+    struct PNode {
+        DataType data;
+        PNode* left;
+        PNode* right;
+        uint32_t height; ///< the number of levels in this subtree
+        std::atomic<uint32_t> refs; ///< the number of owners
+        PNode(PNode* left, const DataType& data, PNode* right)
+            : data(data), left(left), right(right), refs(1) {}
+    };
+
+    PNode* root;
+    uint32_t nodeCount;
+
+    static uint32_t heightOf(const PNode* n);
+    static PNode* make(PNode* left, const DataType& data, PNode* right);
+    static PNode* acquire(PNode* n);
+    static void release(PNode* n);
+    static PNode* balance(PNode* left, const DataType& data, PNode* right);
+    static PNode* insert(PNode* n, const DataType& data, bool& added);
+    template<class Key>
+    static PNode* remove(PNode* n, const Key& data, bool& removed);
+    static PNode* removeMin(PNode* n, const DataType*& min);
+    static void walk(TreeTraverse order, const PNode* n, uint32_t level,
+                     void (*func)(const DataType&, uint32_t));
+public:
+    PersistentBinTree(); ///< default constructor
+    PersistentBinTree(std::initializer_list<DataType> data);
+    ~PersistentBinTree();
+    //MANAGE DATA//////////////////////////////////////////////
+    uint32_t count() const; ///< get the number of items in the tree
+    uint32_t height() const;
+    bool insert(const DataType& data);
+    template<class Key>
+    bool remove(const Key& data);
+    template<class Key>
+    const std::pair<bool, uint32_t> search(const Key& data) const;
+    template<class Key>
+    bool contains(const Key& data) const;
+    void traverse(TreeTraverse order,
+                  void (*func)(const DataType&, uint32_t)) const;
+    void erase(); ///< erases the contents of the tree
+    //SNAPSHOT/////////////////////////////////////////////////
+    PersistentBinTree<DataType> snapshot() const;
+    PersistentBinTree(const PersistentBinTree<DataType>& source);
+    PersistentBinTree(PersistentBinTree<DataType>&& source);
+    PersistentBinTree<DataType>&
+    operator=(const PersistentBinTree<DataType>& right);
+    PersistentBinTree<DataType>& operator=(PersistentBinTree<DataType>&& right);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+template<class DataType>
+PersistentBinTree<DataType>::PersistentBinTree() {
+    root = NULL;
+    nodeCount = 0;
+}
+
+///@brief starting value constructor, data may be in any order
+template<class DataType>
+PersistentBinTree<DataType>::PersistentBinTree(
+        std::initializer_list<DataType> data) : PersistentBinTree() {
+    for (const DataType& i : data)
+        insert(i);
+}
+
+template<class DataType>
+PersistentBinTree<DataType>::~PersistentBinTree() {
+    release(root);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PUBLIC
+template<class DataType>
+uint32_t PersistentBinTree<DataType>::count() const {
+    return nodeCount;
+}
+
+template<class DataType>
+uint32_t PersistentBinTree<DataType>::height() const {
+    return heightOf(root);
+}
+
+/**@brief adds data to the tree, copying the path to it
+   @param data the data to add
+   @return false if data was already in the tree
+*/
+template<class DataType>
+bool PersistentBinTree<DataType>::insert(const DataType& data) {
+    bool added = false;
+    PNode* newRoot = insert(root, data, added);
+    if (!added)
+        return false;
+    release(root);
+    root = newRoot;
+    nodeCount++;
+    return true;
+}
+
+/**@brief removes data from the tree, copying the path to it
+   @param data the data to remove
+   @return false if data was not in the tree
+*/
+template<class DataType>
+template<class Key>
+bool PersistentBinTree<DataType>::remove(const Key& data) {
+    bool removed = false;
+    PNode* newRoot = remove(root, data, removed);
+    if (!removed)
+        return false;
+    release(root);
+    root = newRoot;
+    nodeCount--;
+    return true;
+}
+
+/**@brief searches the tree
+   @param data the data to search for
+   @return an std::pair<bool, uint32_t> of whether the data exists and the
+           level that it is on
+*/
+template<class DataType>
+template<class Key>
+const std::pair<bool, uint32_t>
+PersistentBinTree<DataType>::search(const Key& data) const {
+    const PNode* n = root;
+    uint32_t level = 0;
+    while (n != NULL)
+    {
+        if (data < n->data)
+            n = n->left;
+        else if (n->data < data)
+            n = n->right;
+        else
+            return std::make_pair(true, level);
+        level++;
+    }
+    return std::make_pair(false, 0);
+}
+
+///@brief checks if data is in the tree
+template<class DataType>
+template<class Key>
+bool PersistentBinTree<DataType>::contains(const Key& data) const {
+    return search(data).first;
+}
+
+///@brief runs a user-supplied function on every item in the tree
+template<class DataType>
+void PersistentBinTree<DataType>::traverse(TreeTraverse order,
+                        void (*func)(const DataType&, uint32_t)) const {
+    walk(order, root, 0, func);
+}
+
+///@brief erases the contents of the tree, snapshots are not affected
+template<class DataType>
+void PersistentBinTree<DataType>::erase() {
+    release(root);
+    root = NULL;
+    nodeCount = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//SNAPSHOT
+/**@brief makes a copy of the tree as it is now, in O(1)
+
+The snapshot and the tree share every node. Changing either one copies the
+nodes it changes, so the other never sees the change.
+*/
+template<class DataType>
+PersistentBinTree<DataType> PersistentBinTree<DataType>::snapshot() const {
+    return PersistentBinTree<DataType>(*this);
+}
+
+///@brief copy constructor, a snapshot of source
+template<class DataType>
+PersistentBinTree<DataType>::PersistentBinTree(
+        const PersistentBinTree<DataType>& source) {
+    root = acquire(source.root);
+    nodeCount = source.nodeCount;
+}
+
+template<class DataType>
+PersistentBinTree<DataType>::PersistentBinTree(
+        PersistentBinTree<DataType>&& source) {
+    root = source.root;
+    nodeCount = source.nodeCount;
+    source.root = NULL;
+    source.nodeCount = 0;
+}
+
+template<class DataType>
+PersistentBinTree<DataType>&
+PersistentBinTree<DataType>::operator=(
+        const PersistentBinTree<DataType>& right) {
+    PNode* old = root;
+    root = acquire(right.root); //before the release, in case right is *this
+    nodeCount = right.nodeCount;
+    release(old);
+    return *this;
+}
+
+template<class DataType>
+PersistentBinTree<DataType>&
+PersistentBinTree<DataType>::operator=(PersistentBinTree<DataType>&& right) {
+    std::swap(root, right.root);
+    std::swap(nodeCount, right.nodeCount);
+    return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+template<class DataType>
+uint32_t PersistentBinTree<DataType>::heightOf(const PNode* n) {
+    return (n == NULL) ? 0 : n->height;
+}
+
+/**@brief builds a new node
+   @param left the left child, the new node takes over the caller's reference
+   @param data the data to copy into the node
+   @param right the right child, also taken over
+   @return the node, with 1 reference that belongs to the caller
+*/
+template<class DataType>
+typename PersistentBinTree<DataType>::PNode*
+PersistentBinTree<DataType>::make(PNode* left, const DataType& data,
+                                  PNode* right) {
+    PNode* n = new PNode(left, data, right);
+    uint32_t l = heightOf(left), r = heightOf(right);
+    n->height = 1 + (l > r ? l : r);
+    return n;
+}
+
+///@brief adds a reference to a node, returns the node
+template<class DataType>
+typename PersistentBinTree<DataType>::PNode*
+PersistentBinTree<DataType>::acquire(PNode* n) {
+    if (n != NULL)
+        n->refs.fetch_add(1, std::memory_order_relaxed);
+    return n;
+}
+
+/**@brief drops a reference to a node, freeing it if that was the last one
+
+Freeing a node drops its references to its children, which may free them in
+turn. The nodes to drop are kept on a stack, so freeing a whole tree does not
+recurse.
+*/
+template<class DataType>
+void PersistentBinTree<DataType>::release(PNode* n) {
+    std::vector<PNode*> stack;
+    while (n != NULL)
+    {
+        if (n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            if (n->left != NULL)
+                stack.push_back(n->left);
+            if (n->right != NULL)
+                stack.push_back(n->right);
+            delete n;
+        }
+        n = NULL;
+        if (!stack.empty())
+        {
+            n = stack.back();
+            stack.pop_back();
+        }
+    }
+}
+
+/**@brief joins two subtrees under data, rotating if they are out of balance
+   @param left a reference owned by the caller, taken over
+   @param right a reference owned by the caller, taken over
+   @return the new subtree
+
+The heights of left and right differ by at most 2 (as after an AVL insert or
+remove). Rotations build new nodes around the children they keep, and drop
+the nodes they replace.
+*/
+template<class DataType>
+typename PersistentBinTree<DataType>::PNode*
+PersistentBinTree<DataType>::balance(PNode* left, const DataType& data,
+                                     PNode* right) {
+    uint32_t l = heightOf(left), r = heightOf(right);
+    PNode* n;
+    if (l > r + 1)
+    {
+        if (heightOf(left->left) >= heightOf(left->right)) //single rotation
+            n = make(acquire(left->left), left->data,
+                     make(acquire(left->right), data, right));
+        else //double rotation
+        {
+            PNode* mid = left->right;
+            n = make(make(acquire(left->left), left->data,
+                          acquire(mid->left)),
+                     mid->data,
+                     make(acquire(mid->right), data, right));
+        }
+        release(left);
+        return n;
+    }
+    if (r > l + 1)
+    {
+        if (heightOf(right->right) >= heightOf(right->left))
+            n = make(make(left, data, acquire(right->left)), right->data,
+                     acquire(right->right));
+        else
+        {
+            PNode* mid = right->left;
+            n = make(make(left, data, acquire(mid->left)),
+                     mid->data,
+                     make(acquire(mid->right), right->data,
+                          acquire(right->right)));
+        }
+        release(right);
+        return n;
+    }
+    return make(left, data, right);
+}
+
+/**@brief copies the path to where data belongs, with data added
+   @param n the subtree to add data to, it is not changed
+   @param data the data to add
+   @param added set to false if data is a duplicate
+   @return the new subtree (a new reference), NULL if nothing was added
+*/
+template<class DataType>
+typename PersistentBinTree<DataType>::PNode*
+PersistentBinTree<DataType>::insert(PNode* n, const DataType& data,
+                                    bool& added) {
+    if (n == NULL)
+    {
+        added = true;
+        return make(NULL, data, NULL);
+    }
+    if (data < n->data)
+    {
+        PNode* left = insert(n->left, data, added);
+        if (!added)
+            return NULL;
+        return balance(left, n->data, acquire(n->right));
+    }
+    if (n->data < data)
+    {
+        PNode* right = insert(n->right, data, added);
+        if (!added)
+            return NULL;
+        return balance(acquire(n->left), n->data, right);
+    }
+    return NULL;
+}
+
+///@brief copies the path to data, without data, see insert()
+template<class DataType>
+template<class Key>
+typename PersistentBinTree<DataType>::PNode*
+PersistentBinTree<DataType>::remove(PNode* n, const Key& data,
+                                    bool& removed) {
+    if (n == NULL)
+        return NULL;
+    if (data < n->data)
+    {
+        PNode* left = remove(n->left, data, removed);
+        if (!removed)
+            return NULL;
+        return balance(left, n->data, acquire(n->right));
+    }
+    if (n->data < data)
+    {
+        PNode* right = remove(n->right, data, removed);
+        if (!removed)
+            return NULL;
+        return balance(acquire(n->left), n->data, right);
+    }
+
+    removed = true;
+    if (n->left == NULL)
+        return acquire(n->right);
+    if (n->right == NULL)
+        return acquire(n->left);
+    //the successor takes n's place
+    const DataType* min;
+    PNode* right = removeMin(n->right, min);
+    return balance(acquire(n->left), *min, right);
+}
+
+/**@brief copies the path to the smallest item, without it
+   @param min set to the smallest item, which is still in the old tree
+*/
+template<class DataType>
+typename PersistentBinTree<DataType>::PNode*
+PersistentBinTree<DataType>::removeMin(PNode* n, const DataType*& min) {
+    if (n->left == NULL)
+    {
+        min = &n->data;
+        return acquire(n->right);
+    }
+    PNode* left = removeMin(n->left, min);
+    return balance(left, n->data, acquire(n->right));
+}
+
+template<class DataType>
+void PersistentBinTree<DataType>::walk(TreeTraverse order, const PNode* n,
+                                       uint32_t level,
+                                       void (*func)(const DataType&,
+                                                    uint32_t)) {
+    if (n == NULL)
+        return;
+    if (order == PRE_ORDER)
+        func(n->data, level);
+    walk(order, n->left, level + 1, func);
+    if (order == IN_ORDER)
+        func(n->data, level);
+    walk(order, n->right, level + 1, func);
+    if (order == POST_ORDER)
+        func(n->data, level);
+}
+
+#endif // PERSISTENTBINTREE_HH
@@ -0,0 +1,490 @@
+///@file RadixTrie.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef RADIXTRIE_HH
+#define RADIXTRIE_HH
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include "NodePool.hh"
+
+/**@brief A sorted set of strings, stored as a compressed (Patricia) trie
+
+Every edge is labelled with a run of characters, and a key is the labels
+along the path from the root to a node that is marked as a key. A node only
+exists where keys branch off or end, so there are at most two nodes per key.
+
+* search(), insert() and remove() look at each character of the key once,
+  plus one lookup among the children at each node on the way down. Their
+  cost depends on the length of the key, not on the number of keys. A
+  BinTree<std::string> compares whole strings at each of its lg(n) levels,
+  and keys with a long common prefix pay for that prefix every time.
+* prefixScan() finds every key starting with a prefix by going down to the
+  prefix's node, then walking only the subtree below it
+* Keys come out in lexicographic order (by unsigned char), the same order
+  as std::string's <
+* Each node keeps the first character of each child's label in one string,
+  so choosing a child is a memchr over at most 256 bytes
+* Nodes come from a NodePool, like BinTree's
+
+~~~~~{.cc}
+RadixTrie crew {"Kirk", "Spock", "Sisko", "Sulu", "Scotty"};
+crew.prefixScan("S", [](const string& name) {
+    cout << name << endl; //Scotty Sisko Spock Sulu
+});
+~~~~~
+*/
+class RadixTrie {
+private:
+    struct TrieNode {
+        std::string label; ///< the characters on the edge from the parent
+        std::string firsts; ///< the first character of each child, sorted
+        std::vector<TrieNode*> children; ///< in the same order as firsts
+        bool isKey; ///< whether the path to this node spells a key
+    };
+    TrieNode root; ///< always there, with an empty label
+    NodePool<TrieNode> pool;
+    uint32_t nodeCount; ///< the number of keys
+
+    TrieNode* newNode(std::string_view label, bool isKey);
+    void delNode(TrieNode* n);
+    void clear();
+    static TrieNode* child(const TrieNode* n, char first);
+    static void addChild(TrieNode* n, TrieNode* c);
+    void mergeChild(TrieNode* n);
+    void clone(TrieNode& to, const TrieNode& from);
+    template<class Visit>
+    static bool scan(const TrieNode* n, std::string& key, Visit& visit);
+    template<class Visit>
+    static bool keepGoing(Visit& visit, const std::string& key);
+public:
+    /**@brief A forward iterator that visits the keys in order
+
+    Builds each key as it goes (the trie does not store whole keys), so
+    the string it points to changes on ++. Any insert or remove makes it
+    invalid.
+    */
+    class iterator {
+    private:
+        ///each node on the way down, and the next of its children to visit
+        std::vector<std::pair<const TrieNode*, size_t> > path;
+        std::string key;
+        friend class RadixTrie;
+        void advance();
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::string value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const std::string* pointer;
+        typedef const std::string& reference;
+
+        reference operator*() const { return key; }
+        pointer operator->() const { return &key; }
+        iterator& operator++() {
+            advance();
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator old = *this;
+            advance();
+            return old;
+        }
+        bool operator==(const iterator& right) const {
+            return path.size() == right.path.size() &&
+                   (path.empty() || path.back().first ==
+                                    right.path.back().first);
+        }
+        bool operator!=(const iterator& right) const {
+            return !(*this == right);
+        }
+    };
+    typedef iterator const_iterator;
+
+    RadixTrie(); ///< default constructor
+    RadixTrie(std::initializer_list<std::string_view> keys);
+    ~RadixTrie();
+    //MANAGE DATA//////////////////////////////////////////////
+    uint32_t count() const; ///< get the number of keys in the trie
+    size_t nodes() const; ///< get the number of nodes, not counting root
+    void insert(std::string_view key);
+    void insert(std::initializer_list<std::string_view> keys);
+    const bool remove(std::string_view key);
+    const std::pair<bool, uint32_t> search(std::string_view key) const;
+    template<class Visit>
+    bool prefixScan(std::string_view prefix, Visit&& visit) const;
+    template<class Visit>
+    bool traverse(Visit&& visit) const;
+    void erase(); ///< erases the contents of the trie
+    //ITERATE//////////////////////////////////////////////////
+    iterator begin() const; ///< get the smallest key
+    iterator end() const; ///< get the position after the largest key
+    //COPY/////////////////////////////////////////////////////
+    RadixTrie(const RadixTrie& source);
+    RadixTrie(RadixTrie&& source);
+    RadixTrie& operator=(const RadixTrie& right);
+    RadixTrie& operator=(RadixTrie&& right);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////////////
+inline RadixTrie::RadixTrie() {
+    root.isKey = false;
+    nodeCount = 0;
+}
+
+///@brief starting value constructor, keys may be in any order
+inline RadixTrie::RadixTrie(std::initializer_list<std::string_view> keys)
+    : RadixTrie() {
+    insert(keys);
+}
+
+inline RadixTrie::~RadixTrie() {
+    clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PUBLIC
+inline uint32_t RadixTrie::count() const {
+    return nodeCount;
+}
+
+inline size_t RadixTrie::nodes() const {
+    return pool.size();
+}
+
+/**@brief adds a key to the trie
+   @param key the key to add, nothing happens if it is already there
+
+Goes down while the key matches whole labels. Where it stops partway along
+a label, that edge is split in two with a new node between, and the rest of
+the key (if any) becomes a new leaf.
+*/
+inline void RadixTrie::insert(std::string_view key) {
+    TrieNode* n = &root;
+    size_t pos = 0;
+    while (pos < key.size())
+    {
+        TrieNode* c = child(n, key[pos]);
+        if (c == NULL)
+        {
+            addChild(n, newNode(key.substr(pos), true));
+            nodeCount++;
+            return;
+        }
+
+        //how much of c's label matches the key (at least its first character)
+        std::string_view rest = key.substr(pos);
+        size_t match = std::mismatch(c->label.begin(), c->label.end(),
+                                     rest.begin(), rest.end()).first -
+                       c->label.begin();
+        if (match < c->label.size())
+        {
+            //split c's edge, mid takes c's place under n
+            TrieNode* mid = newNode(std::string_view(c->label).substr(0, match),
+                                    false);
+            c->label.erase(0, match);
+            n->children[n->firsts.find(mid->label[0])] = mid;
+            addChild(mid, c);
+            c = mid;
+        }
+        pos += match;
+        n = c;
+    }
+    if (!n->isKey)
+    {
+        n->isKey = true;
+        nodeCount++;
+    }
+}
+
+///@brief insert multiple keys, in any order
+inline void RadixTrie::insert(std::initializer_list<std::string_view> keys) {
+    for (std::string_view k : keys)
+        insert(k);
+}
+
+/**@brief remove a key from the trie
+   @return true if the key was found and removed, false if it does not exist
+
+Keeps the trie compressed: a node that is no longer a key and has no
+children is deleted, and one left with a single child is merged with it.
+*/
+inline const bool RadixTrie::remove(std::string_view key) {
+    TrieNode* parent = NULL;
+    TrieNode* n = &root;
+    size_t pos = 0;
+    while (pos < key.size())
+    {
+        TrieNode* c = child(n, key[pos]);
+        if (c == NULL || key.compare(pos, c->label.size(), c->label) != 0)
+            return false;
+        pos += c->label.size();
+        parent = n;
+        n = c;
+    }
+    if (!n->isKey)
+        return false;
+
+    n->isKey = false;
+    nodeCount--;
+    if (n == &root)
+        return true;
+    if (n->children.empty())
+    {
+        size_t i = parent->firsts.find(n->label[0]);
+        parent->firsts.erase(i, 1);
+        parent->children.erase(parent->children.begin() + i);
+        delNode(n);
+        if (parent != &root && !parent->isKey && parent->children.size() == 1)
+            mergeChild(parent);
+    }
+    else if (n->children.size() == 1)
+        mergeChild(n);
+    return true;
+}
+
+/**@brief looks up a key
+   @param key the key to search for
+   @return an std::pair<bool, uint32_t> of whether the key exists and the
+           number of nodes passed on the way to it below root (disregard the
+           level if it does not)
+*/
+inline const std::pair<bool, uint32_t>
+RadixTrie::search(std::string_view key) const {
+    const TrieNode* n = &root;
+    size_t pos = 0;
+    uint32_t level = 0;
+    while (pos < key.size())
+    {
+        const TrieNode* c = child(n, key[pos]);
+        if (c == NULL || key.compare(pos, c->label.size(), c->label) != 0)
+            return std::make_pair(false, 0);
+        pos += c->label.size();
+        n = c;
+        level++;
+    }
+    return std::make_pair(n->isKey, n->isKey ? level : 0);
+}
+
+/**@brief runs a function on every key that starts with prefix, in order
+   @param prefix the start of the keys to visit ("" visits every key)
+   @param visit called as visit(const std::string& key). If it returns a
+          bool, returning false stops the scan.
+   @return false if visit stopped the scan early
+
+Only the nodes on the way down to the prefix and the nodes below it are
+visited, so the cost is the length of the prefix plus the size of the
+answer.
+*/
+template<class Visit>
+bool RadixTrie::prefixScan(std::string_view prefix, Visit&& visit) const {
+    const TrieNode* n = &root;
+    size_t pos = 0;
+    std::string key; //the labels above n, scan() adds n's own
+    while (pos < prefix.size())
+    {
+        const TrieNode* c = child(n, prefix[pos]);
+        if (c == NULL)
+            return true;
+        //the prefix may end partway along c's label
+        size_t length = std::min(c->label.size(), prefix.size() - pos);
+        if (prefix.compare(pos, length, c->label, 0, length) != 0)
+            return true;
+        key += n->label;
+        pos += length;
+        n = c;
+    }
+    return scan(n, key, visit);
+}
+
+///@brief runs a function on every key in order, see prefixScan()
+template<class Visit>
+bool RadixTrie::traverse(Visit&& visit) const {
+    return prefixScan("", visit);
+}
+
+inline void RadixTrie::erase() {
+    clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//ITERATE
+inline RadixTrie::iterator RadixTrie::begin() const {
+    iterator i;
+    i.path.push_back(std::make_pair(&root, 0));
+    if (!root.isKey)
+        i.advance();
+    return i;
+}
+
+inline RadixTrie::iterator RadixTrie::end() const {
+    return iterator();
+}
+
+///@brief moves to the next node that is a key, in preorder
+inline void RadixTrie::iterator::advance() {
+    while (!path.empty())
+    {
+        std::pair<const TrieNode*, size_t>& top = path.back();
+        if (top.second < top.first->children.size())
+        {
+            const TrieNode* c = top.first->children[top.second++];
+            path.push_back(std::make_pair(c, 0));
+            key += c->label;
+            if (c->isKey)
+                return;
+        }
+        else
+        {
+            key.resize(key.size() - top.first->label.size());
+            path.pop_back();
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//COPY
+inline RadixTrie::RadixTrie(const RadixTrie& source) : RadixTrie() {
+    clone(root, source.root);
+    nodeCount = source.nodeCount;
+}
+
+inline RadixTrie::RadixTrie(RadixTrie&& source) : RadixTrie() {
+    *this = std::move(source);
+}
+
+inline RadixTrie& RadixTrie::operator=(const RadixTrie& right) {
+    if (this == &right)
+        return *this;
+    clear();
+    clone(root, right.root);
+    nodeCount = right.nodeCount;
+    return *this;
+}
+
+///@brief takes over right's nodes, right is left empty
+inline RadixTrie& RadixTrie::operator=(RadixTrie&& right) {
+    if (this == &right)
+        return *this;
+    clear();
+    std::swap(root.firsts, right.root.firsts);
+    std::swap(root.children, right.root.children);
+    std::swap(root.isKey, right.root.isKey);
+    std::swap(nodeCount, right.nodeCount);
+    pool.swap(right.pool);
+    return *this;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+inline RadixTrie::TrieNode* RadixTrie::newNode(std::string_view label,
+                                               bool isKey) {
+    TrieNode* n = new (pool.allocate()) TrieNode;
+    n->label = label;
+    n->isKey = isKey;
+    return n;
+}
+
+///@brief deletes n and everything below it
+inline void RadixTrie::delNode(TrieNode* n) {
+    for (TrieNode* c : n->children)
+        delNode(c);
+    n->~TrieNode();
+    pool.deallocate(n);
+}
+
+///@brief deletes every node and gives the pool's memory back
+inline void RadixTrie::clear() {
+    for (TrieNode* c : root.children)
+        delNode(c);
+    root.firsts.clear();
+    root.children.clear();
+    root.isKey = false;
+    nodeCount = 0;
+    pool.release();
+}
+
+///@brief finds the child of n whose label starts with first, NULL if none
+inline RadixTrie::TrieNode* RadixTrie::child(const TrieNode* n, char first) {
+    size_t i = n->firsts.find(first);
+    return (i == std::string::npos) ? NULL : n->children[i];
+}
+
+///@brief adds c below n, keeping the children sorted
+inline void RadixTrie::addChild(TrieNode* n, TrieNode* c) {
+    const unsigned char first = c->label[0];
+    size_t i = 0;
+    while (i < n->firsts.size() &&
+           static_cast<unsigned char>(n->firsts[i]) < first)
+        i++;
+    n->firsts.insert(n->firsts.begin() + i, c->label[0]);
+    n->children.insert(n->children.begin() + i, c);
+}
+
+/**@brief merges n with its only child, when n is not a key
+
+The child's label is added to the end of n's, so n keeps its first
+character and its place under its parent.
+*/
+inline void RadixTrie::mergeChild(TrieNode* n) {
+    TrieNode* c = n->children[0];
+    n->label += c->label;
+    n->isKey = c->isKey;
+    n->firsts = std::move(c->firsts);
+    n->children = std::move(c->children);
+    c->~TrieNode();
+    pool.deallocate(c);
+}
+
+///@brief copies everything below from to below to, node for node
+inline void RadixTrie::clone(TrieNode& to, const TrieNode& from) {
+    to.isKey = from.isKey;
+    to.firsts = from.firsts;
+    to.children.resize(from.children.size());
+    for (size_t i = 0; i < from.children.size(); i++)
+    {
+        const TrieNode* c = from.children[i];
+        to.children[i] = newNode(c->label, c->isKey);
+        clone(*to.children[i], *c);
+    }
+}
+
+/**@brief visits every key at and below n, in order
+   @param key the characters above n, restored before returning
+   @return false if visit stopped the scan early
+
+Recursive, so the stack grows with the number of nodes on the longest path
+(at most the length of the longest key).
+*/
+template<class Visit>
+bool RadixTrie::scan(const TrieNode* n, std::string& key, Visit& visit) {
+    key += n->label;
+    bool going = !n->isKey || keepGoing(visit, key);
+    for (size_t i = 0; going && i < n->children.size(); i++)
+        going = scan(n->children[i], key, visit);
+    key.resize(key.size() - n->label.size());
+    return going;
+}
+
+///@brief calls visit(key), returns false if visit returned false
+template<class Visit>
+bool RadixTrie::keepGoing(Visit& visit, const std::string& key) {
+    typedef decltype(visit(key)) Returns;
+    if constexpr (std::is_void<Returns>::value)
+    {
+        visit(key);
+        return true;
+    }
+    else
+        return static_cast<bool>(visit(key));
+}
+
+#endif // RADIXTRIE_HH
@@ -0,0 +1,174 @@
+///@file TreeStats.hh
+///@author Caleb Reister <calebreister@gmail.com>
+
+#ifndef TREESTATS_HH
+#define TREESTATS_HH
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+/**@brief A running total kept by a tree, such as the number of rotations
+
+Counters bumped by lookups (see BINTREE_COUNT) may be bumped by several
+threads at once. A locked add would cost more than the rest of the
+bookkeeping put together, so each add is a plain (relaxed) load and store:
+always safe, exact for one thread, and may miss a few counts while several
+threads search at the same time. That is close enough for monitoring.
+*/
+class TreeCounter {
+private:
+    std::atomic<uint64_t> value;
+public:
+    TreeCounter() : value(0) {}
+    void add(uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n,
+                    std::memory_order_relaxed);
+    }
+    ///@brief raises the counter to n if it is lower
+    void raise(uint64_t n) {
+        if (value.load(std::memory_order_relaxed) < n)
+            value.store(n, std::memory_order_relaxed);
+    }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+    void reset() { value.store(0, std::memory_order_relaxed); }
+};
+
+///@brief How long the calls to one operation took (see BINTREE_STATS)
+struct OpTiming {
+    uint64_t calls = 0;
+    uint64_t totalNs = 0; ///< the time spent in every call, in nanoseconds
+    uint64_t maxNs = 0;   ///< the slowest call, in nanoseconds
+};
+
+/**@brief A picture of a tree's shape and of the work it has done
+
+Returned by BinTree::stats(). The shape (height, depths) describes the tree
+as it is now. The counters cover the work done since the tree was created or
+since BinTree::resetStats().
+
+A healthy tree has height close to optimalHeight and averagePath close to
+lg(count). A plain UNBALANCED tree fed sorted data shows height == count.
+*/
+struct TreeStats {
+    uint32_t count = 0;         ///< the number of items
+    uint32_t height = 0;        ///< levels on the longest root-to-leaf path
+    uint32_t optimalHeight = 0; ///< the height of a perfectly balanced tree
+    ///the number of nodes on each level, root first
+    std::vector<uint32_t> depths;
+    ///nodes visited by a search for an item, averaged over every item
+    double averagePath = 0;
+
+    ///data comparisons made searching the tree, only counted for insert
+    ///unless BINTREE_STATS is defined
+    uint64_t comparisons = 0;
+    uint64_t allocations = 0; ///< nodes allocated
+    uint64_t rotations = 0;   ///< rotations made to keep the tree balanced
+    ///misses answered by the filter alone, only counted with BINTREE_STATS
+    uint64_t filtered = 0;
+    size_t filterBytes = 0;   ///< the memory the filter takes, 0 if none
+
+    ///timings, only collected when BINTREE_STATS is defined
+    OpTiming insert, search, remove;
+
+    std::string toJson() const;
+};
+
+/**@brief writes the stats as one line of JSON
+
+~~~~~{.json}
+{"count":13,"height":4,"optimalHeight":4,"depths":[1,2,4,6],
+ "averagePath":3.15385,"comparisons":52,"allocations":13,"rotations":0,
+ "filtered":0,"filterBytes":0}
+~~~~~
+
+With BINTREE_STATS defined, a "timings" object follows, holding "insert",
+"search" and "remove", each with "calls", "totalNs" and "maxNs".
+*/
+inline std::string TreeStats::toJson() const {
+    char buffer[64];
+    std::string json = "{\"count\":" + std::to_string(count) +
+                       ",\"height\":" + std::to_string(height) +
+                       ",\"optimalHeight\":" + std::to_string(optimalHeight) +
+                       ",\"depths\":[";
+    for (size_t i = 0; i < depths.size(); i++)
+        json += (i == 0 ? "" : ",") + std::to_string(depths[i]);
+    snprintf(buffer, sizeof(buffer), "%g", averagePath); //no trailing zeros
+    json += std::string("],\"averagePath\":") + buffer +
+            ",\"comparisons\":" + std::to_string(comparisons) +
+            ",\"allocations\":" + std::to_string(allocations) +
+            ",\"rotations\":" + std::to_string(rotations) +
+            ",\"filtered\":" + std::to_string(filtered) +
+            ",\"filterBytes\":" + std::to_string(filterBytes);
+#ifdef BINTREE_STATS
+    const char* const names[] = {"insert", "search", "remove"};
+    const OpTiming* const ops[] = {&insert, &search, &remove};
+    json += ",\"timings\":{";
+    for (int i = 0; i < 3; i++)
+    {
+        json += std::string(i == 0 ? "" : ",") + "\"" + names[i] +
+                "\":{\"calls\":" + std::to_string(ops[i]->calls) +
+                ",\"totalNs\":" + std::to_string(ops[i]->totalNs) +
+                ",\"maxNs\":" + std::to_string(ops[i]->maxNs) + "}";
+    }
+    json += "}";
+#endif
+    return json + "}";
+}
+
+#ifdef BINTREE_STATS
+///@brief The running totals behind one OpTiming
+struct OpTimer {
+    TreeCounter calls, totalNs, maxNs;
+
+    OpTiming get() const {
+        OpTiming t;
+        t.calls = calls.get();
+        t.totalNs = totalNs.get();
+        t.maxNs = maxNs.get();
+        return t;
+    }
+    void reset() {
+        calls.reset();
+        totalNs.reset();
+        maxNs.reset();
+    }
+};
+
+///@brief Times its own lifetime and adds it to an OpTimer
+class ScopedOpTimer {
+private:
+    OpTimer& timer;
+    std::chrono::steady_clock::time_point start;
+public:
+    explicit ScopedOpTimer(OpTimer& timer)
+        : timer(timer), start(std::chrono::steady_clock::now()) {}
+    ~ScopedOpTimer() {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start).count();
+        timer.calls.add(1);
+        timer.totalNs.add(ns);
+        timer.maxNs.raise(ns);
+    }
+};
+
+/**Times the rest of the enclosing block as one call of op. Defining
+BINTREE_STATS before including BinTree.hh turns this on, otherwise it is
+nothing at all and the hot paths carry no timing code.
+*/
+#define BINTREE_TIME(op) ScopedOpTimer opTimer_(op)
+
+/**Adds n to a counter on a lookup path (search, find, remove, lower_bound,
+upper_bound, searchBatch). Without BINTREE_STATS it is left out, so lookups
+from several threads never write to the tree's cache lines.
+*/
+#define BINTREE_COUNT(counter, n) (counter).add(n)
+#else
+#define BINTREE_TIME(op)
+#define BINTREE_COUNT(counter, n) static_cast<void>(n)
+#endif
+
+#endif // TREESTATS_HH
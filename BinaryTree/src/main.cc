@@ -25,6 +25,21 @@ int main() {
         cout << endl;
     }
 
+    cout << "Copy from C to Q\n";
+    for (const string& name : crewCopy.range("C", "Q"))
+        cout << name << endl;
+    cout << endl;
+
+    cout << "First 3 names in the copy\n";
+    int printed = 0;
+    crewCopy.traverse(IN_ORDER, [&printed](const string& name, uint32_t) {
+        cout << name << endl;
+        return ++printed < 3;
+    });
+    cout << endl;
+
+    cout << "Stats for the copy\n" << crewCopy.stats().toJson() << "\n\n";
+
     cout << "Copy in PRE_ORDER\n";
     crewCopy.traverse(PRE_ORDER, printMember);
     cout << endl << "Copy in POST_ORDER\n";
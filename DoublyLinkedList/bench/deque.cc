@@ -0,0 +1,108 @@
+/**@file deque.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Times filling a DoublyLinkedList<int> with size items and emptying it again,
+sorted (insert()) against unsorted (push_back(), push_front(), pop_front(),
+pop_back()).
+Outputs CSV to the file given as the first argument (deque.csv by default).
+
+                          , 1000, 10000, 100000, 1000000
+    SORTED INSERT ORDERED , 0.000062, ...
+    SORTED INSERT RANDOM  , ...
+    PUSH_BACK             , ...
+    PUSH_FRONT            , ...
+    POP_FRONT             , ...
+    POP_BACK              , ...
+
+Every value is the time in seconds for the whole phase. SORTED INSERT
+ORDERED feeds insert() an ascending stream, SORTED INSERT RANDOM a shuffled
+one.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "DoublyLinkedList.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest list to build
+
+enum Phase {ORDERED, RANDOM, PUSH_BACK, PUSH_FRONT, POP_FRONT, POP_BACK};
+const int phaseCount = 6;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "deque.csv" : argv[1]);
+    string rows[phaseCount];
+
+    out << ",";
+    for (uint32_t size = 1000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+        vector<int> items(size);
+        for (uint32_t i = 0; i < size; i++)
+            items[i] = i;
+
+        DoublyLinkedList<int> sorted;
+        auto start = chrono::steady_clock::now();
+        for (int i : items)
+            sorted.insert(i);
+        rows[ORDERED] += to_string(since(start)) + ",";
+        sorted.removeAll();
+
+        shuffle(items.begin(), items.end(), mt19937(42));
+        start = chrono::steady_clock::now();
+        for (int i : items)
+            sorted.insert(i);
+        rows[RANDOM] += to_string(since(start)) + ",";
+        if (sorted.getCount() != size)
+            cerr << "Items were lost at size " << size << endl;
+
+        DoublyLinkedList<int> deque(UNSORTED);
+        start = chrono::steady_clock::now();
+        for (int i : items)
+            deque.push_back(i);
+        rows[PUSH_BACK] += to_string(since(start)) + ",";
+        start = chrono::steady_clock::now();
+        for (int i : items)
+            deque.push_front(i);
+        rows[PUSH_FRONT] += to_string(since(start)) + ",";
+
+        //pops half each way, so the list ends up empty
+        long sum = 0;
+        start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < size; i++)
+        {
+            sum += deque.front();
+            deque.pop_front();
+        }
+        rows[POP_FRONT] += to_string(since(start)) + ",";
+        start = chrono::steady_clock::now();
+        for (uint32_t i = 0; i < size; i++)
+        {
+            sum -= deque.back();
+            deque.pop_back();
+        }
+        rows[POP_BACK] += to_string(since(start)) + ",";
+
+        if (sum != 0 || deque.getCount() != 0)
+            cerr << "The deque lost track at size " << size << endl;
+        cout << "Finished size " << size << "." << endl;
+    }
+
+    const string phaseStr[] = {"SORTED INSERT ORDERED", "SORTED INSERT RANDOM",
+                               "PUSH_BACK", "PUSH_FRONT", "POP_FRONT",
+                               "POP_BACK"};
+    for (int p = 0; p < phaseCount; p++)
+        out << endl << phaseStr[p] << "," << rows[p];
+    out << endl;
+}
@@ -0,0 +1,82 @@
+/**@file sorted.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Times a SORTED DoublyLinkedList<int> as a set: size inserts in random order,
+lookupCount searches (half of them missing), then size removes in another
+random order.
+Outputs CSV to the file given as the first argument (sorted.csv by default).
+
+           , 1000, 10000, 100000, 1000000
+    INSERT , 0.00015, ...
+    SEARCH , ...
+    REMOVE , ...
+
+Every value is the time in seconds for the whole phase.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "DoublyLinkedList.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest list to build
+const uint32_t lookupCount = 100000; ///<The number of searches to time
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "sorted.csv" : argv[1]);
+    string rows[3];
+
+    out << ",";
+    for (uint32_t size = 1000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+
+        //even items are in the list, odd items never are
+        vector<int> items(size);
+        for (uint32_t i = 0; i < size; i++)
+            items[i] = 2 * i;
+        shuffle(items.begin(), items.end(), mt19937(42));
+        mt19937 rng(7);
+        vector<int> lookups(lookupCount);
+        for (int& i : lookups)
+            i = rng() % (2 * size);
+
+        DoublyLinkedList<int> list;
+        auto start = chrono::steady_clock::now();
+        for (int i : items)
+            list.insert(i);
+        rows[0] += to_string(since(start)) + ",";
+
+        uint32_t found = 0;
+        start = chrono::steady_clock::now();
+        for (int i : lookups)
+            found += list.search(i);
+        rows[1] += to_string(since(start)) + ",";
+
+        shuffle(items.begin(), items.end(), mt19937(3));
+        start = chrono::steady_clock::now();
+        for (int i : items)
+            list.remove(i);
+        rows[2] += to_string(since(start)) + ",";
+
+        if (list.getCount() != 0 || found == 0)
+            cerr << "The list lost track at size " << size << endl;
+        cout << "Finished size " << size << "." << endl;
+    }
+
+    const string rowStr[] = {"INSERT", "SEARCH", "REMOVE"};
+    for (int r = 0; r < 3; r++)
+        out << endl << rowStr[r] << "," << rows[r];
+    out << endl;
+}
@@ -0,0 +1,110 @@
+/**@file unrolled.cc
+@author Caleb Reister <calebreister@gmail.com>
+
+Compares an UnrolledList<int> (32 items per node) with a DoublyLinkedList<int>
+holding the same items. For each size, each list:
+- pushes size items onto the back of an UNSORTED list, copies it, and
+  compares the two with operator== (which walks both lists)
+- inserts size items in random order into a SORTED list (up to
+  maxSortedSize), copies it, and compares the two with operator==. The
+  nodes of a list built this way are scattered in memory, the way a long
+  lived list's would be.
+Outputs CSV to the file given as the first argument (unrolled.csv by
+default).
+
+                          , 1000, 10000, 100000, 1000000
+    LINKED PUSH_BACK      , 0.000035, ...
+    LINKED EQUALS         , ...
+    LINKED SORTED INSERT  , ...
+    LINKED SORTED EQUALS  , ...
+    UNROLLED PUSH_BACK    , ...
+    ...
+
+Every value is the time in seconds for the whole phase. SORTED rows are
+left empty past maxSortedSize.
+*/
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "DoublyLinkedList.hh"
+#include "UnrolledList.hh"
+using namespace std;
+
+const uint32_t maxSize = 1000000; ///<The biggest list to build
+const uint32_t maxSortedSize = 100000; ///<The biggest list to sort randomly
+
+enum Phase {PUSH_BACK, EQUALS, SORTED_INSERT, SORTED_EQUALS};
+const int phaseCount = 4;
+
+///@brief the number of seconds since start
+double since(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start)
+           .count();
+}
+
+/**@brief runs every phase on one kind of list
+   @param rows one row per Phase, each gets a value appended
+   @return the number of comparisons that found the lists equal
+*/
+template<class List>
+int run(const vector<int>& items, string rows[]) {
+    int equal = 0;
+    List deque(UNSORTED), dequeCopy(UNSORTED);
+    auto start = chrono::steady_clock::now();
+    for (int i : items)
+        deque.push_back(i);
+    rows[PUSH_BACK] += to_string(since(start)) + ",";
+    dequeCopy = deque;
+    start = chrono::steady_clock::now();
+    equal += deque == dequeCopy;
+    rows[EQUALS] += to_string(since(start)) + ",";
+
+    if (items.size() <= maxSortedSize)
+    {
+        List sorted, sortedCopy;
+        start = chrono::steady_clock::now();
+        for (int i : items)
+            sorted.insert(i);
+        rows[SORTED_INSERT] += to_string(since(start));
+        sortedCopy = sorted;
+        start = chrono::steady_clock::now();
+        equal += sorted == sortedCopy;
+        rows[SORTED_EQUALS] += to_string(since(start));
+    }
+    rows[SORTED_INSERT] += ",";
+    rows[SORTED_EQUALS] += ",";
+    return equal;
+}
+
+int main(int argc, char* argv[]) {
+    ofstream out(argc == 1 ? "unrolled.csv" : argv[1]);
+    const string phaseStr[] = {"PUSH_BACK", "EQUALS", "SORTED INSERT",
+                               "SORTED EQUALS"};
+    string linkedRows[phaseCount], unrolledRows[phaseCount];
+
+    out << ",";
+    for (uint32_t size = 1000; size <= maxSize; size *= 10)
+    {
+        out << size << ",";
+        vector<int> items(size);
+        for (uint32_t i = 0; i < size; i++)
+            items[i] = i;
+        shuffle(items.begin(), items.end(), mt19937(42));
+
+        if (run<DoublyLinkedList<int> >(items, linkedRows) !=
+            run<UnrolledList<int> >(items, unrolledRows))
+            cerr << "The lists disagree at size " << size << endl;
+        cout << "Finished size " << size << "." << endl;
+    }
+
+    for (int p = 0; p < phaseCount; p++)
+        out << endl << "LINKED " << phaseStr[p] << "," << linkedRows[p];
+    for (int p = 0; p < phaseCount; p++)
+        out << endl << "UNROLLED " << phaseStr[p] << "," << unrolledRows[p];
+    out << endl;
+}
@@ -9,6 +9,7 @@
 
 #include <string>
 #include <iostream>
+#include <random>
 
 /////////////////////////////////////////////////////////////////////////
 //PROTOTYPES
@@ -45,30 +46,85 @@ bool operator<=(const DoublyLinkedList<DataType>& a,
 
 //////////////////////////////////////////////////////////////
 //CLASS DECLARATIONS
+/**@brief How a DoublyLinkedList keeps its items
+ *
+ * - SORTED: in order, without duplicates (insert() finds the spot)
+ * - UNSORTED: in the order they were added, duplicates allowed, so the
+ *   list works as a deque
+ */
+enum ListOrder {SORTED, UNSORTED};
+
 ///@brief A singe node for a DoublyLinkedList
+///
+///In a SORTED list, some nodes are also on one or more express lanes (see
+///DoublyLinkedList), which skip over the nodes below them.
 template<class DataType>
 struct Node {
     DataType data;
     Node<DataType>* prev;
     Node<DataType>* next;
+    Node<DataType>** skip;  ///the next node on each express lane, or NULL
+    unsigned int levels;    ///1 + the number of express lanes it is on
+
+    Node() {
+        prev = NULL;
+        next = NULL;
+        skip = NULL;
+        levels = 1;
+    }
+    ~Node() {
+        delete[] skip;
+    }
 };
 
+/**@brief A doubly linked list, either SORTED or UNSORTED (see ListOrder)
+ *
+ * A SORTED list is also a skip list: above the list itself are express
+ * lanes, each linking about a quarter of the nodes of the lane below it.
+ * Searches run along the top lane and drop down a lane whenever the next
+ * node would overshoot, so insert(), remove() and search() take O(log n)
+ * expected time instead of walking from head. The prev and next links are
+ * untouched by all of this, so walking the list either way still works.
+ */
 template<class DataType>
 class DoublyLinkedList {
     private:
+    static constexpr unsigned int maxLevels = 16;  ///enough for 4^16 items
+
     Node<DataType>* head;  ///the beginning of the list
     Node<DataType>* tail;  ///the end of the list
     unsigned int count;  ///the number of items in the list
+    ListOrder order;  ///whether insert() keeps the list sorted
+    Node<DataType>* lanes[maxLevels - 1];  ///the first node on each lane
+    Node<DataType>* ends[maxLevels - 1];  ///the last node on each lane
+    unsigned int levels;  ///1 + the number of express lanes in use
+    std::minstd_rand levelRng;  ///picks how many lanes a new node is on
     void removeNode(Node<DataType>* n);
-    bool checkData(Node<DataType>* newNode, Node<DataType>* oldNode);
+    void unlink(Node<DataType>* n);
+    //express lanes
+    unsigned int randomLevels();
+    Node<DataType>*& laneFrom(Node<DataType>* n, unsigned int level);
+    void skipOver(Node<DataType>* n, Node<DataType>** before);
+    void findBefore(const DataType& data, Node<DataType>** before) const;
+    void link(Node<DataType>* n, Node<DataType>** before);
+    void unindex(Node<DataType>* n);
 
     public:
-    DoublyLinkedList();
+    DoublyLinkedList(ListOrder order = SORTED);
     ~DoublyLinkedList();
     bool insert(DataType data);
     bool remove(DataType data);
     void removeAll();
+    bool search(const DataType& data) const;
+    //deque operations, O(1) (O(log n) for pop_back() in a SORTED list)
+    bool push_back(const DataType& data);
+    bool push_front(const DataType& data);
+    bool pop_back();
+    bool pop_front();
+    DataType& back();
+    DataType& front();
     unsigned int getCount();
+    ListOrder getOrder();
     void printReverse(std::ostream& output);
     //operator overloads
     DoublyLinkedList<DataType>& operator=(const DoublyLinkedList<DataType>& data);
@@ -90,11 +146,19 @@ class DoublyLinkedList {
 
 /////////////////////////////////////////////////////////////////////////////////////
 //MEMBERS
+/**@brief Creates an empty list
+ * @param order SORTED (the default) to keep the items in order without
+ * duplicates, UNSORTED to keep them in the order they are added
+ */
 template<class DataType>
-DoublyLinkedList<DataType>::DoublyLinkedList() {
+DoublyLinkedList<DataType>::DoublyLinkedList(ListOrder order) {
     head = NULL;
     tail = NULL;
     count = 0;
+    this->order = order;
+    for (unsigned int i = 0; i < maxLevels - 1; i++)
+        lanes[i] = ends[i] = NULL;
+    levels = 1;
 }
 
 template<class DataType>
@@ -114,21 +178,25 @@ void DoublyLinkedList<DataType>::removeNode(Node<DataType>* n) {
     }
 }
 
-/**@brief Checks Nodes for equality, and deletes the new one if they are the
- * the same, useful when adding a new Node to the list.
- * @param newNode The Node that is deleted conditionally
- * @param oldNode The Node to check newNode against
- * @return true if the nodes are equal
+/**@brief Takes a node out of the list, fixes the links around it, and
+ * deletes it
+ * @param n The node to remove, must be in this list and already off every
+ * express lane (see unindex())
  */
 template<class DataType>
-bool DoublyLinkedList<DataType>::checkData(Node<DataType>* newNode,
-                                           Node<DataType>* oldNode) {
-    if (newNode->data == oldNode->data)
-    {
-        delete newNode;
-        return true;
-    }
-    return false;
+void DoublyLinkedList<DataType>::unlink(Node<DataType>* n) {
+    if (n->prev == NULL)
+        head = n->next;
+    else
+        n->prev->next = n->next;
+
+    if (n->next == NULL)
+        tail = n->prev;
+    else
+        n->next->prev = n->prev;
+
+    delete n;
+    count--;
 }
 
 /**@brief Insert data into the list
@@ -139,59 +207,24 @@ bool DoublyLinkedList<DataType>::checkData(Node<DataType>* newNode,
  *
  * Notes:\n
  * - Duplicate data is not accepted\n
- * - The list is automatically organized alphabetically
+ * - The list is automatically organized alphabetically\n
+ * - The express lanes find the spot in O(log n) expected time\n
+ * - In an UNSORTED list, data is simply added to the end (see push_back())
  */
 template<class DataType>
 bool DoublyLinkedList<DataType>::insert(DataType data) {
-    //Initialize
-    Node<DataType>* n = new Node<DataType>;
-    n->data = data;
-
-    if (head == NULL)  //list empty?
-    {
-        head = n;
-        tail = n;
-    }
-    else if (n->data <= head->data)  //1st item?
-    {
-        if (checkData(n, head))
-            return false;
-        n->next = head;
-        head->prev = n;
-        head = n;
-    }
-    else if (n->data >= tail->data)  //last item?
-    {
-        if (checkData(n, tail))
-            return false;
-        tail->next = n;
-        n->prev = tail;
-        tail = n;
-    }
-    else  //insert in the middle
-    {
-        Node<DataType>* current = head;
-        //find where to insert
-        while (current->data < n->data)
-            current = current->next;
-
-        //check the data
-        if (checkData(n, current))
-            return false;
-
-        //update pointers
-        n->next = current;
-        n->prev = current->prev;
-        current->prev->next = n;
-        current->prev = n;
-    }
+    if (order == UNSORTED)
+        return push_back(data);
 
-    //make sure head does not have a previous and tail
-    //does not have a next pointer
-    tail->next = NULL;
-    head->prev = NULL;
+    Node<DataType>* before[maxLevels];
+    findBefore(data, before);
+    Node<DataType>* next = before[0] == NULL ? head : before[0]->next;
+    if (next != NULL && next->data == data)
+        return false;
 
-    count++;
+    Node<DataType>* n = new Node<DataType>;
+    n->data = data;
+    link(n, before);
     return true;
 }
 
@@ -204,50 +237,38 @@ bool DoublyLinkedList<DataType>::insert(DataType data) {
  * - If the data does not exist for any reason, false is returned\n\n
  *
  * False is not necessarily an error condition, it just means that
- * the data was not found in the list.
+ * the data was not found in the list.\n
+ * In an UNSORTED list, only the first copy of data is removed.
  */
 template<class DataType>
 bool DoublyLinkedList<DataType>::remove(DataType data) {
-    if (head == NULL)  //No data in the list
-        return false;
-
-    else if (data == head->data)  //remove 1st item
-    {
-        Node<DataType>* temp = head;
-        head = head->next;
-        delete temp;
-        count--;
-        if (count == 0)
-        {
-            delete head;
-            head = NULL;
-            tail = NULL;
-        }
-        return true;
-    }
-    else if (data == tail->data)  //last item
+    if (order == SORTED)
     {
-        Node<DataType>* temp = tail;
-        tail = tail->prev;
-        delete temp;
-        tail->next = NULL;
-        count--;
+        Node<DataType>* before[maxLevels];
+        findBefore(data, before);
+        Node<DataType>* n = before[0] == NULL ? head : before[0]->next;
+        if (n == NULL || !(n->data == data))
+            return false;
+        skipOver(n, before);
+        unlink(n);
         return true;
     }
 
+    if (head == NULL)  //No data in the list
+        return false;
+    else if (data == head->data)  //remove 1st item
+        return pop_front();
+
     //find node to delete
-    Node<DataType>* current = head;
+    Node<DataType>* current = head->next;
     while (current != NULL)
     {
-        current = current->next;
         if (current->data == data)
         {
-            current->prev->next = current->next;
-            current->next->prev = current->prev;
-            delete current;
-            count--;
+            unlink(current);
             return true;
         }
+        current = current->next;
     }
 
     return false;
@@ -270,9 +291,127 @@ void DoublyLinkedList<DataType>::removeAll() {
         delete head;
         head = NULL;
         tail = NULL;
+        for (unsigned int i = 0; i < maxLevels - 1; i++)
+            lanes[i] = ends[i] = NULL;
+        levels = 1;
     }
 }
 
+/**@brief Checks whether data is in the list
+ * @return true if an item equal to data is in the list
+ *
+ * O(log n) expected in a SORTED list, a walk from head in an UNSORTED one.
+ */
+template<class DataType>
+bool DoublyLinkedList<DataType>::search(const DataType& data) const {
+    Node<DataType>* n = head;
+    if (order == SORTED)
+    {
+        Node<DataType>* before[maxLevels];
+        findBefore(data, before);
+        n = before[0] == NULL ? head : before[0]->next;
+        return n != NULL && n->data == data;
+    }
+
+    while (n != NULL && !(n->data == data))
+        n = n->next;
+    return n != NULL;
+}
+
+/**@brief Adds data to the end of the list in O(1)
+ * @param data The data to add
+ * @return true if data was added\n
+ *         false if the list is SORTED and data is not greater than the
+ *         last item (it would break the order, use insert() instead)
+ *
+ * In a SORTED list, this is insert() with the order checked first, which
+ * finds the end of each express lane without searching.
+ */
+template<class DataType>
+bool DoublyLinkedList<DataType>::push_back(const DataType& data) {
+    if (order == SORTED)
+        return (tail == NULL || tail->data < data) && insert(data);
+
+    Node<DataType>* n = new Node<DataType>;
+    n->data = data;
+    n->prev = tail;
+    n->next = NULL;
+    if (tail == NULL)
+        head = n;
+    else
+        tail->next = n;
+    tail = n;
+    count++;
+    return true;
+}
+
+/**@brief Adds data to the beginning of the list in O(1)
+ * @param data The data to add
+ * @return true if data was added\n
+ *         false if the list is SORTED and data is not less than the first
+ *         item (it would break the order, use insert() instead)
+ */
+template<class DataType>
+bool DoublyLinkedList<DataType>::push_front(const DataType& data) {
+    if (order == SORTED)
+        return (head == NULL || data < head->data) && insert(data);
+
+    Node<DataType>* n = new Node<DataType>;
+    n->data = data;
+    n->prev = NULL;
+    n->next = head;
+    if (head == NULL)
+        tail = n;
+    else
+        head->prev = n;
+    head = n;
+    count++;
+    return true;
+}
+
+/**@brief Removes the last item in O(1)
+ * @return false if the list was already empty
+ *
+ * In a SORTED list, the item may first need to be taken off its express
+ * lanes, which is O(log n).
+ */
+template<class DataType>
+bool DoublyLinkedList<DataType>::pop_back() {
+    if (tail == NULL)
+        return false;
+    unindex(tail);
+    unlink(tail);
+    return true;
+}
+
+/**@brief Removes the first item in O(1)
+ * @return false if the list was already empty
+ */
+template<class DataType>
+bool DoublyLinkedList<DataType>::pop_front() {
+    if (head == NULL)
+        return false;
+    unindex(head);
+    unlink(head);
+    return true;
+}
+
+/**@brief Get the last item
+ * @return The data at the end of the list, the list must not be empty
+ */
+template<class DataType>
+DataType& DoublyLinkedList<DataType>::back() {
+    return tail->data;
+}
+
+/**@brief Get the first item
+ * @return The data at the beginning of the list, the list must not be empty
+ */
+template<class DataType>
+DataType& DoublyLinkedList<DataType>::front() {
+    return head->data;
+}
+
 /**@brief Get the number of items in the list
  * @return The number of items in the linked list
  *  as an unsigned int.
@@ -282,6 +421,12 @@ unsigned int DoublyLinkedList<DataType>::getCount() {
     return count;
 }
 
+///@brief Get whether the list is SORTED or UNSORTED
+template<class DataType>
+ListOrder DoublyLinkedList<DataType>::getOrder() {
+    return order;
+}
+
 ///@brief Prints the list in reverse to the specified output stream
 template<class DataType>
 void DoublyLinkedList<DataType>::printReverse(std::ostream& stream) {
@@ -297,6 +442,136 @@ void DoublyLinkedList<DataType>::printReverse(std::ostream& stream) {
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+//EXPRESS LANES
+/**@brief Picks how many levels a new node is on: 1 (just the list) with
+ * probability 3/4, each extra lane with probability 1/4 of the one before
+ */
+template<class DataType>
+unsigned int DoublyLinkedList<DataType>::randomLevels() {
+    unsigned int bits = levelRng();
+    unsigned int n = 1;
+    while ((bits & 3) == 0 && n < maxLevels)
+    {
+        n++;
+        bits >>= 2;
+    }
+    return n;
+}
+
+/**@brief Get the link to the node after n on a level
+ * @param n A node on the level, or NULL for the start of the level
+ * @param level 0 for the list itself, 1 and up for the express lanes
+ * @return the link itself, so it can be changed
+ */
+template<class DataType>
+Node<DataType>*& DoublyLinkedList<DataType>::laneFrom(Node<DataType>* n,
+                                                     unsigned int level) {
+    if (level == 0)
+        return n == NULL ? head : n->next;
+    return n == NULL ? lanes[level - 1] : n->skip[level - 1];
+}
+
+/**@brief Finds where data belongs on every level
+ * @param data The data to look for
+ * @param before Filled with the last node less than data on each level in
+ * use (before[0] on the list itself), NULL where no node is
+ *
+ * Data past the end of the list is found in O(1), so appending an ordered
+ * stream does not search at all.
+ */
+template<class DataType>
+void DoublyLinkedList<DataType>::findBefore(const DataType& data,
+                                            Node<DataType>** before) const {
+    if (tail != NULL && tail->data < data)
+    {
+        before[0] = tail;
+        for (unsigned int i = 1; i < levels; i++)
+            before[i] = ends[i - 1];
+        return;
+    }
+
+    Node<DataType>* n = NULL;
+    for (unsigned int i = levels - 1; i > 0; i--)
+    {
+        Node<DataType>* next = n == NULL ? lanes[i - 1] : n->skip[i - 1];
+        while (next != NULL && next->data < data)
+        {
+            n = next;
+            next = n->skip[i - 1];
+        }
+        before[i] = n;
+    }
+
+    Node<DataType>* next = n == NULL ? head : n->next;
+    while (next != NULL && next->data < data)
+    {
+        n = next;
+        next = n->next;
+    }
+    before[0] = n;
+}
+
+/**@brief Links a new node in after the nodes findBefore() found, on the
+ * list and on a random number of express lanes
+ * @param n The new node
+ * @param before From findBefore(), may grow by the lanes n starts
+ */
+template<class DataType>
+void DoublyLinkedList<DataType>::link(Node<DataType>* n,
+                                      Node<DataType>** before) {
+    n->levels = randomLevels();
+    for (; levels < n->levels; levels++)
+        before[levels] = NULL;
+    if (n->levels > 1)
+        n->skip = new Node<DataType>*[n->levels - 1];
+    for (unsigned int i = 1; i < n->levels; i++)
+    {
+        Node<DataType>*& from = laneFrom(before[i], i);
+        n->skip[i - 1] = from;
+        from = n;
+        if (n->skip[i - 1] == NULL)
+            ends[i - 1] = n;
+    }
+
+    n->prev = before[0];
+    n->next = laneFrom(before[0], 0);
+    laneFrom(before[0], 0) = n;
+    if (n->next == NULL)
+        tail = n;
+    else
+        n->next->prev = n;
+    count++;
+}
+
+/**@brief Takes a node off every express lane it is on, in O(log n)
+ *
+ * Most nodes are on none (and in an UNSORTED list, no node is), which
+ * takes O(1).
+ */
+template<class DataType>
+void DoublyLinkedList<DataType>::unindex(Node<DataType>* n) {
+    if (n->levels == 1)
+        return;
+    Node<DataType>* before[maxLevels];
+    findBefore(n->data, before);
+    skipOver(n, before);
+}
+
+/**@brief Links around n on each express lane it is on
+ * @param before From findBefore() for n's data
+ */
+template<class DataType>
+void DoublyLinkedList<DataType>::skipOver(Node<DataType>* n,
+                                          Node<DataType>** before) {
+    for (unsigned int i = 1; i < n->levels; i++)
+    {
+        laneFrom(before[i], i) = n->skip[i - 1];
+        if (ends[i - 1] == n)
+            ends[i - 1] = before[i];
+    }
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 //OPERATORS
 ///@brief Performs a deep copy of the list
@@ -304,7 +579,9 @@ void DoublyLinkedList<DataType>::printReverse(std::ostream& stream) {
 ///NOTE: this process may be taxing depending on the size of the list, as
 ///all of the contents are copied.\n\n
 ///This function has been fully tested, and the addresses are all different according
-///to the debugger.
+///to the debugger.\n
+///The list keeps its own order (SORTED or UNSORTED), so copying an UNSORTED
+///list into a SORTED one sorts it and drops duplicates.
 template<class DataType>
 DoublyLinkedList<DataType>&
 DoublyLinkedList<DataType>::operator=(const DoublyLinkedList<DataType>& data) {
@@ -0,0 +1,597 @@
+/**@file UnrolledList.hh
+ * @author Caleb Reister <calebreister@gmail.com>
+ * @brief Declaration and implementation of the UnrolledList class template,
+ * a DoublyLinkedList that keeps several items in each node
+ */
+
+#ifndef UNROLLED_LIST_HH
+#define UNROLLED_LIST_HH
+
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <utility>
+#include "DoublyLinkedList.hh"
+
+/////////////////////////////////////////////////////////////////////////
+//PROTOTYPES
+template<class DataType, unsigned int K>
+class UnrolledList;
+
+template<class DataType, unsigned int K>
+std::ostream& operator<<(std::ostream& stream,
+                         const UnrolledList<DataType, K>& data);
+
+template<class DataType, unsigned int K>
+bool operator==(const UnrolledList<DataType, K>& a,
+                const UnrolledList<DataType, K>& b);
+
+template<class DataType, unsigned int K>
+bool operator!=(const UnrolledList<DataType, K>& a,
+                const UnrolledList<DataType, K>& b);
+
+template<class DataType, unsigned int K>
+bool operator>(const UnrolledList<DataType, K>& a,
+               const UnrolledList<DataType, K>& b);
+
+template<class DataType, unsigned int K>
+bool operator<(const UnrolledList<DataType, K>& a,
+               const UnrolledList<DataType, K>& b);
+
+template<class DataType, unsigned int K>
+bool operator>=(const UnrolledList<DataType, K>& a,
+                const UnrolledList<DataType, K>& b);
+
+template<class DataType, unsigned int K>
+bool operator<=(const UnrolledList<DataType, K>& a,
+                const UnrolledList<DataType, K>& b);
+
+//////////////////////////////////////////////////////////////
+//CLASS DECLARATIONS
+///@brief A node for an UnrolledList, holding up to K items in a row
+template<class DataType, unsigned int K>
+struct UnrolledNode {
+    UnrolledNode<DataType, K>* prev;
+    UnrolledNode<DataType, K>* next;
+    unsigned int used;  ///the number of items in data, the rest are unused
+    DataType data[K];
+};
+
+/**@brief A DoublyLinkedList with up to K items in each node
+ *
+ * The API is the same as DoublyLinkedList's (minus the express lanes), and
+ * it can be SORTED or UNSORTED the same way. Keeping K items side by side
+ * means walking the list (printing, comparing) misses the cache about once
+ * per node instead of once per item, and there are two pointers per K items
+ * instead of per item.
+ *
+ * - An insert into a full node splits it in two halves, except at the end
+ *   of the list, where a new node is started so an ordered stream fills
+ *   every node
+ * - A remove that leaves a node under half full merges it with a neighbor
+ *   when they fit in 3/4 of a node
+ * - Finding the spot for an item in a SORTED list hops from node to node,
+ *   which is O(n/K), and then moves up to K items over. That is slower than
+ *   DoublyLinkedList's express lanes once the list is big.
+ */
+template<class DataType, unsigned int K = 32>
+class UnrolledList {
+    static_assert(K >= 4, "an UnrolledList needs room for 4 items per node");
+
+    private:
+    typedef UnrolledNode<DataType, K> Block;
+
+    Block* head;  ///the first node
+    Block* tail;  ///the last node
+    unsigned int count;  ///the number of items in the list
+    ListOrder order;  ///whether insert() keeps the list sorted
+    Block* newBlock(Block* after);
+    void dropBlock(Block* b);
+    void append(const DataType& data);
+    void insertAt(Block* b, unsigned int i, const DataType& data);
+    void removeAt(Block* b, unsigned int i);
+    Block* findBlock(const DataType& data) const;
+    static unsigned int findIn(const Block* b, const DataType& data);
+    template<class Fails>
+    static bool allPairs(const UnrolledList& a, const UnrolledList& b,
+                         Fails fails);
+
+    public:
+    UnrolledList(ListOrder order = SORTED);
+    UnrolledList(const UnrolledList<DataType, K>& source);
+    ~UnrolledList();
+    bool insert(DataType data);
+    bool remove(DataType data);
+    void removeAll();
+    bool search(const DataType& data) const;
+    //deque operations, O(1) (O(K) at the front, and to keep nodes packed)
+    bool push_back(const DataType& data);
+    bool push_front(const DataType& data);
+    bool pop_back();
+    bool pop_front();
+    DataType& back();
+    DataType& front();
+    unsigned int getCount();
+    ListOrder getOrder();
+    void printReverse(std::ostream& output);
+    //operator overloads
+    UnrolledList<DataType, K>& operator=(const UnrolledList<DataType, K>& data);
+    friend std::ostream& operator<< <>(std::ostream& stream,
+                                       const UnrolledList& data);
+    friend bool operator== <>(const UnrolledList& a, const UnrolledList& b);
+    friend bool operator!= <>(const UnrolledList& a, const UnrolledList& b);
+    friend bool operator> <>(const UnrolledList& a, const UnrolledList& b);
+    friend bool operator< <>(const UnrolledList& a, const UnrolledList& b);
+    friend bool operator>= <>(const UnrolledList& a, const UnrolledList& b);
+    friend bool operator<= <>(const UnrolledList& a, const UnrolledList& b);
+};
+
+/////////////////////////////////////////////////////////////////////////////////
+//MEMBERS
+/**@brief Creates an empty list
+ * @param order SORTED (the default) to keep the items in order without
+ * duplicates, UNSORTED to keep them in the order they are added
+ */
+template<class DataType, unsigned int K>
+UnrolledList<DataType, K>::UnrolledList(ListOrder order) {
+    head = NULL;
+    tail = NULL;
+    count = 0;
+    this->order = order;
+}
+
+///@brief Copies source item by item, with the same order, into packed nodes
+template<class DataType, unsigned int K>
+UnrolledList<DataType, K>::UnrolledList(
+    const UnrolledList<DataType, K>& source) {
+    head = NULL;
+    tail = NULL;
+    count = 0;
+    order = source.order;
+    *this = source;
+}
+
+template<class DataType, unsigned int K>
+UnrolledList<DataType, K>::~UnrolledList() {
+    removeAll();
+}
+
+/**@brief Insert data into the list
+ * @param data The data to add, can be any type with the appropriate
+ * operators.
+ * @return Data inserted: true\n
+ *         Duplicate data: false
+ *
+ * Notes:\n
+ * - Duplicate data is not accepted\n
+ * - The list is automatically organized alphabetically\n
+ * - Data past the end is appended in O(1)\n
+ * - In an UNSORTED list, data is simply added to the end (see push_back())
+ */
+template<class DataType, unsigned int K>
+bool UnrolledList<DataType, K>::insert(DataType data) {
+    if (order == UNSORTED || tail == NULL ||
+        tail->data[tail->used - 1] < data)
+    {
+        append(data);
+        return true;
+    }
+
+    Block* b = findBlock(data);
+    unsigned int i = findIn(b, data);
+    if (b->data[i] == data)
+        return false;
+    insertAt(b, i, data);
+    return true;
+}
+
+/**@brief Removes the specified data from the list
+ * @param data The data to remove, any type with the appropriate operators
+ * @return True if data was removed, false if it was not in the list
+ *
+ * In an UNSORTED list, only the first copy of data is removed.
+ */
+template<class DataType, unsigned int K>
+bool UnrolledList<DataType, K>::remove(DataType data) {
+    if (order == SORTED)
+    {
+        if (tail == NULL || tail->data[tail->used - 1] < data)
+            return false;
+        Block* b = findBlock(data);
+        unsigned int i = findIn(b, data);
+        if (!(b->data[i] == data))
+            return false;
+        removeAt(b, i);
+        return true;
+    }
+
+    for (Block* b = head; b != NULL; b = b->next)
+    {
+        for (unsigned int i = 0; i < b->used; i++)
+        {
+            if (b->data[i] == data)
+            {
+                removeAt(b, i);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+///@brief Erases the contents of the list and cleans up appropriately
+template<class DataType, unsigned int K>
+void UnrolledList<DataType, K>::removeAll() {
+    while (head != NULL)
+    {
+        Block* next = head->next;
+        delete head;
+        head = next;
+    }
+    tail = NULL;
+    count = 0;
+}
+
+/**@brief Checks whether data is in the list
+ * @return true if an item equal to data is in the list
+ */
+template<class DataType, unsigned int K>
+bool UnrolledList<DataType, K>::search(const DataType& data) const {
+    if (order == SORTED)
+    {
+        if (tail == NULL || tail->data[tail->used - 1] < data)
+            return false;
+        const Block* b = findBlock(data);
+        return b->data[findIn(b, data)] == data;
+    }
+
+    for (const Block* b = head; b != NULL; b = b->next)
+    {
+        for (unsigned int i = 0; i < b->used; i++)
+        {
+            if (b->data[i] == data)
+                return true;
+        }
+    }
+    return false;
+}
+
+/**@brief Adds data to the end of the list in O(1)
+ * @return true if data was added\n
+ *         false if the list is SORTED and data is not greater than the
+ *         last item (it would break the order, use insert() instead)
+ */
+template<class DataType, unsigned int K>
+bool UnrolledList<DataType, K>::push_back(const DataType& data) {
+    if (order == SORTED && tail != NULL && !(tail->data[tail->used - 1] < data))
+        return false;
+    append(data);
+    return true;
+}
+
+/**@brief Adds data to the beginning of the list in O(K)
+ * @return true if data was added\n
+ *         false if the list is SORTED and data is not less than the first
+ *         item (it would break the order, use insert() instead)
+ */
+template<class DataType, unsigned int K>
+bool UnrolledList<DataType, K>::push_front(const DataType& data) {
+    if (order == SORTED && head != NULL && !(data < head->data[0]))
+        return false;
+    if (head == NULL || head->used == K)
+        newBlock(NULL);
+    insertAt(head, 0, data);
+    return true;
+}
+
+/**@brief Removes the last item
+ * @return false if the list was already empty
+ */
+template<class DataType, unsigned int K>
+bool UnrolledList<DataType, K>::pop_back() {
+    if (tail == NULL)
+        return false;
+    removeAt(tail, tail->used - 1);
+    return true;
+}
+
+/**@brief Removes the first item, in O(K) since the rest of its node moves
+ * @return false if the list was already empty
+ */
+template<class DataType, unsigned int K>
+bool UnrolledList<DataType, K>::pop_front() {
+    if (head == NULL)
+        return false;
+    removeAt(head, 0);
+    return true;
+}
+
+/**@brief Get the last item
+ * @return The data at the end of the list, the list must not be empty
+ */
+template<class DataType, unsigned int K>
+DataType& UnrolledList<DataType, K>::back() {
+    return tail->data[tail->used - 1];
+}
+
+/**@brief Get the first item
+ * @return The data at the beginning of the list, the list must not be empty
+ */
+template<class DataType, unsigned int K>
+DataType& UnrolledList<DataType, K>::front() {
+    return head->data[0];
+}
+
+///@brief Get the number of items in the list
+template<class DataType, unsigned int K>
+unsigned int UnrolledList<DataType, K>::getCount() {
+    return count;
+}
+
+///@brief Get whether the list is SORTED or UNSORTED
+template<class DataType, unsigned int K>
+ListOrder UnrolledList<DataType, K>::getOrder() {
+    return order;
+}
+
+///@brief Prints the list in reverse to the specified output stream
+template<class DataType, unsigned int K>
+void UnrolledList<DataType, K>::printReverse(std::ostream& stream) {
+    if (tail != NULL)
+    {
+        for (Block* b = tail; b != NULL; b = b->prev)
+        {
+            for (unsigned int i = b->used; i > 0; i--)
+                stream << b->data[i - 1] << std::endl;
+        }
+        stream << std::endl;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+//PRIVATE
+/**@brief Links a new, empty node into the list
+ * @param after The node to put it after, NULL to make it the new head
+ * @return the new node
+ */
+template<class DataType, unsigned int K>
+typename UnrolledList<DataType, K>::Block*
+UnrolledList<DataType, K>::newBlock(Block* after) {
+    Block* b = new Block;
+    b->used = 0;
+    b->prev = after;
+    b->next = after == NULL ? head : after->next;
+    if (after == NULL)
+        head = b;
+    else
+        after->next = b;
+    if (b->next == NULL)
+        tail = b;
+    else
+        b->next->prev = b;
+    return b;
+}
+
+///@brief Unlinks a node from the list and deletes it, its items go with it
+template<class DataType, unsigned int K>
+void UnrolledList<DataType, K>::dropBlock(Block* b) {
+    if (b->prev == NULL)
+        head = b->next;
+    else
+        b->prev->next = b->next;
+    if (b->next == NULL)
+        tail = b->prev;
+    else
+        b->next->prev = b->prev;
+    delete b;
+}
+
+///@brief Adds data after the last item, starting a new node if tail is full
+template<class DataType, unsigned int K>
+void UnrolledList<DataType, K>::append(const DataType& data) {
+    if (tail == NULL || tail->used == K)
+        newBlock(tail);
+    tail->data[tail->used++] = data;
+    count++;
+}
+
+/**@brief Puts data at position i of node b, moving the items after it over
+ * @param b The node, split in two halves first if it is full
+ * @param i Where in b data goes, from 0 to b->used
+ */
+template<class DataType, unsigned int K>
+void UnrolledList<DataType, K>::insertAt(Block* b, unsigned int i,
+                                         const DataType& data) {
+    if (b->used == K)
+    {
+        Block* half = newBlock(b);
+        std::move(b->data + K / 2, b->data + K, half->data);
+        half->used = K - K / 2;
+        b->used = K / 2;
+        if (i > K / 2)
+        {
+            b = half;
+            i -= K / 2;
+        }
+    }
+
+    std::move_backward(b->data + i, b->data + b->used,
+                       b->data + b->used + 1);
+    b->data[i] = data;
+    b->used++;
+    count++;
+}
+
+/**@brief Takes out the item at position i of node b
+ *
+ * An empty node is dropped. A node under half full is merged with the next
+ * node (or else the previous one) when both fit in 3/4 of a node, so a node
+ * that was just merged has room to take a few inserts before splitting.
+ */
+template<class DataType, unsigned int K>
+void UnrolledList<DataType, K>::removeAt(Block* b, unsigned int i) {
+    std::move(b->data + i + 1, b->data + b->used, b->data + i);
+    b->used--;
+    count--;
+
+    if (b->used == 0)
+        dropBlock(b);
+    else if (b->used < K / 2)
+    {
+        Block* into = b;
+        Block* from = b->next;
+        if (from == NULL || b->used + from->used > K - K / 4)
+        {
+            into = b->prev;
+            from = b;
+        }
+        if (into != NULL && into->used + from->used <= K - K / 4)
+        {
+            std::move(from->data, from->data + from->used,
+                      into->data + into->used);
+            into->used += from->used;
+            dropBlock(from);
+        }
+    }
+}
+
+/**@brief Finds the node data belongs in, in a SORTED list
+ * @return the first node whose last item is not less than data, the last
+ * item of the list must not be less than data
+ */
+template<class DataType, unsigned int K>
+typename UnrolledList<DataType, K>::Block*
+UnrolledList<DataType, K>::findBlock(const DataType& data) const {
+    Block* b = head;
+    while (b->data[b->used - 1] < data)
+        b = b->next;
+    return b;
+}
+
+///@brief the position of the first item in b that is not less than data
+template<class DataType, unsigned int K>
+unsigned int UnrolledList<DataType, K>::findIn(const Block* b,
+                                               const DataType& data) {
+    unsigned int i = 0;
+    while (i < b->used && b->data[i] < data)
+        i++;
+    return i;
+}
+
+/**@brief Walks two lists side by side
+ * @param fails Called with each pair of items, returns true to stop
+ * @return false if the counts differ or fails() stopped the walk
+ */
+template<class DataType, unsigned int K>
+template<class Fails>
+bool UnrolledList<DataType, K>::allPairs(const UnrolledList& a,
+                                         const UnrolledList& b, Fails fails) {
+    if (a.count != b.count)
+        return false;
+
+    const Block* blockA = a.head;
+    const Block* blockB = b.head;
+    unsigned int i = 0, j = 0;
+    while (blockA != NULL && blockB != NULL)
+    {
+        if (fails(blockA->data[i], blockB->data[j]))
+            return false;
+        if (++i == blockA->used)
+        {
+            blockA = blockA->next;
+            i = 0;
+        }
+        if (++j == blockB->used)
+        {
+            blockB = blockB->next;
+            j = 0;
+        }
+    }
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+//OPERATORS
+///@brief Performs a deep copy of the list
+///
+///The list keeps its own order (SORTED or UNSORTED), so copying an UNSORTED
+///list into a SORTED one sorts it and drops duplicates.
+template<class DataType, unsigned int K>
+UnrolledList<DataType, K>&
+UnrolledList<DataType, K>::operator=(const UnrolledList<DataType, K>& data) {
+    if (this == &data)
+        return *this;
+
+    removeAll();
+    for (const Block* b = data.head; b != NULL; b = b->next)
+    {
+        for (unsigned int i = 0; i < b->used; i++)
+            insert(b->data[i]);
+    }
+    return *this;
+}
+
+///@brief prints the list from head to tail, each item on a new line
+template<class DataType, unsigned int K>
+std::ostream& operator<<(std::ostream& stream,
+                         const UnrolledList<DataType, K>& data) {
+    if (data.head != NULL)
+    {
+        for (const UnrolledNode<DataType, K>* b = data.head; b != NULL;
+             b = b->next)
+        {
+            for (unsigned int i = 0; i < b->used; i++)
+                stream << b->data[i] << std::endl;
+        }
+        stream << std::endl;
+    }
+    return stream;
+}
+
+///@brief checks the two lists for equality, checks counts first
+template<class DataType, unsigned int K>
+bool operator==(const UnrolledList<DataType, K>& a,
+                const UnrolledList<DataType, K>& b) {
+    return UnrolledList<DataType, K>::allPairs(a, b,
+        [](const DataType& x, const DataType& y) { return x != y; });
+}
+
+template<class DataType, unsigned int K>
+bool operator!=(const UnrolledList<DataType, K>& a,
+                const UnrolledList<DataType, K>& b) {
+    return a == b ? false : true;
+}
+
+///@return true if a > b, false if not or if the counts are different
+template<class DataType, unsigned int K>
+bool operator>(const UnrolledList<DataType, K>& a,
+               const UnrolledList<DataType, K>& b) {
+    return UnrolledList<DataType, K>::allPairs(a, b,
+        [](const DataType& x, const DataType& y) { return x <= y; });
+}
+
+///@return true if a < b, false if not or if the counts are different
+template<class DataType, unsigned int K>
+bool operator<(const UnrolledList<DataType, K>& a,
+               const UnrolledList<DataType, K>& b) {
+    return UnrolledList<DataType, K>::allPairs(a, b,
+        [](const DataType& x, const DataType& y) { return x >= y; });
+}
+
+///@return true if a >= b, false if not or if the counts are different
+template<class DataType, unsigned int K>
+bool operator>=(const UnrolledList<DataType, K>& a,
+                const UnrolledList<DataType, K>& b) {
+    return UnrolledList<DataType, K>::allPairs(a, b,
+        [](const DataType& x, const DataType& y) { return x < y; });
+}
+
+///@return true if a <= b, false if not or if the counts are different
+template<class DataType, unsigned int K>
+bool operator<=(const UnrolledList<DataType, K>& a,
+                const UnrolledList<DataType, K>& b) {
+    return UnrolledList<DataType, K>::allPairs(a, b,
+        [](const DataType& x, const DataType& y) { return x > y; });
+}
+
+#endif
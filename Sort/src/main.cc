@@ -2,8 +2,8 @@
 ///@author Caleb Reister <calebreister@gmail.com>
 
 /**@mainpage
-The goal of this program is to test merge sort, heap sort, and quick sort with
-automatically-generated data. The time that each algorithm takes is output to a
+The goal of this program is to test merge sort, heap sort, quick sort, and radix
+sort with automatically-generated data. The time that each algorithm takes is output to a
 file.
 
 Arguments:
@@ -34,6 +34,13 @@ The top row is the size of the dataset tested. 100 is referring to an array of
 Below that, the sort mode and data starting order is listed, each with a time
 corresponding to the appropriate array size.
 
+Each sort mode also gets three rows for NARROW data (random values between 0
+and 65535): the time with key narrowing (the default, see @ref sort), the time
+with full-width keys (WIDE KEYS), and the speedup between the two (GAIN). The
+other data orders are narrowed as well, ORDERED and REVERSE never exceed the
+array size and RANDOM never exceeds RAND_MAX, so they are sorted as 16 or
+32-bit keys.
+
 Testable data:
 * The smallest dataset that is tested is an array of 100
 * The maximum size is defined by the constant maxSize in main.cc
@@ -54,6 +61,7 @@ Links:
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <cstdlib>
 #include <cstdint>
 #include <cassert>
@@ -64,10 +72,11 @@ using namespace std;
 
 const index maxSize = 10000000; ///<The biggest array size to test
 
-enum SortMode {QUICK, MERGE, HEAP};
-enum DataOrder {ORDERED, REVERSE, RANDOM};
+enum SortMode {QUICK, MERGE, HEAP, RADIX};
+enum DataOrder {ORDERED, REVERSE, RANDOM, NARROW};
 
-double timeSort(SortMode mode, DataOrder order, uint32_t size);
+double timeSort(SortMode mode, DataOrder order, uint32_t size,
+                bool narrow = true);
 string sortModeStr(SortMode mode);
 
 int main(int argc, char* argv[]) {
@@ -81,7 +90,7 @@ int main(int argc, char* argv[]) {
     for (index i = 100; i <= maxSize; i *= 10)
         out << i << ",";
 
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < 4; i++)
     {
         SortMode mode = static_cast<SortMode>(i);
         out << endl << sortModeStr(mode) << " ORDERED,";
@@ -92,7 +101,24 @@ int main(int argc, char* argv[]) {
             out << timeSort(mode, REVERSE, size) << ",";
         out << endl << sortModeStr(mode) << " RANDOM,";
         for (index size = 100; size <= maxSize; size *= 10)
-            out << timeSort(mode, ORDERED, size) << ",";
+            out << timeSort(mode, RANDOM, size) << ",";
+
+        //narrow-range data, with and without key narrowing
+        ostringstream narrowRow, wideRow, gainRow;
+        for (index size = 100; size <= maxSize; size *= 10)
+        {
+            double narrowTime = timeSort(mode, NARROW, size);
+            double wideTime = timeSort(mode, NARROW, size, false);
+            narrowRow << narrowTime << ",";
+            wideRow << wideTime << ",";
+            if (narrowTime > 0)
+                gainRow << wideTime / narrowTime;
+            gainRow << ",";
+        }
+        out << endl << sortModeStr(mode) << " NARROW," << narrowRow.str();
+        out << endl << sortModeStr(mode) << " NARROW WIDE KEYS,"
+            << wideRow.str();
+        out << endl << sortModeStr(mode) << " NARROW GAIN," << gainRow.str();
         cout << "Finished " << sortModeStr(mode) << " tests." << endl;
     }
 
@@ -102,12 +128,13 @@ int main(int argc, char* argv[]) {
 ///////////////////////////////////////////////////////////////////////////////
 /**@brief Uses the CPU clock to count how long a sorting algorithm takes to run
           on a set of test data
-   @param mode The sorting algorithm to use (QUICK, MERGE, HEAP)
-   @param order The test data to use (RANDOM, REVERSE, or ORDERED)
+   @param mode The sorting algorithm to use (QUICK, MERGE, HEAP, RADIX)
+   @param order The test data to use (RANDOM, REVERSE, ORDERED, or NARROW)
    @param size The max size of the array to generate and test
+   @param narrow Whether the algorithm may narrow the keys (see @ref sort)
    @return The time it took (in seconds) to run the algorithm
 */
-double timeSort(SortMode mode, DataOrder order, uint32_t size) {
+double timeSort(SortMode mode, DataOrder order, uint32_t size, bool narrow) {
     double startTime;
     double timeTaken;
 
@@ -124,23 +151,33 @@ double timeSort(SortMode mode, DataOrder order, uint32_t size) {
             data[i] = i;
         break;
     case REVERSE:
+    {
         long val = static_cast<long>(size - 1);
         for (uint32_t i = 0; i < size; i++)
             data[i] = val--;
         break;
     }
+    case NARROW:
+        srand(42);
+        for (uint32_t i = 0; i < size; i++)
+            data[i] = rand() % 65536;
+        break;
+    }
 
     //TIMED ZONE
     startTime = get_cpu_time();
     switch (mode) {
     case QUICK:
-        sort::quick(data, size);
+        sort::quick(data, size, narrow);
         break;
     case MERGE:
-        sort::merge(data, size);
+        sort::merge(data, size, 0, narrow);
         break;
     case HEAP:
-        sort::heap(data, size);
+        sort::heap(data, size, narrow);
+        break;
+    case RADIX:
+        sort::radix(data, size, narrow);
         break;
     }
     timeTaken = get_cpu_time() - startTime;
@@ -171,6 +208,9 @@ string sortModeStr(SortMode mode) {
     case HEAP:
         return "HEAP";
         break;
+    case RADIX:
+        return "RADIX";
+        break;
     }
     return "";
 }
@@ -27,8 +27,9 @@ using namespace std;
 >>> append rest(right) to result
 >> return result
 */
-void mergeData(long data[], long a[], index aSize,
-               long b[], index bSize) {
+template<class Key>
+void mergeData(Key data[], Key a[], index aSize,
+               Key b[], index bSize) {
     index di = 0, //data index
              ai = 0, //a index
              bi = 0; //b index
@@ -102,7 +103,8 @@ void siftDown( ValType *a, int start, int end)
 }
 ~~~~~
 */
-void siftDown(long data[], index start, index end) {
+template<class Key>
+void siftDown(Key data[], index start, index end) {
     index root = start;
     index child;
 
@@ -120,6 +122,126 @@ void siftDown(long data[], index start, index end) {
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+//KEY NARROWING
+
+template<class Key> void mergeSort(Key data[], index size);
+template<class Key> void quickSort(Key data[], index size);
+template<class Key> void heapSort(Key data[], index size);
+template<class Key> void radixSort(Key data[], index size);
+
+/**@brief Finds the smallest and largest value in an array in a single pass
+   @param data The array to scan (must not be empty)
+   @param size The size of the array
+   @param low Set to the smallest value
+   @param high Set to the largest value
+*/
+void keyRange(const long data[], index size, long& low, long& high) {
+    low = data[0];
+    high = data[0];
+    for (index i = 1; i < size; i++)
+    {
+        if (data[i] < low)
+            low = data[i];
+        else if (data[i] > high)
+            high = data[i];
+    }
+}
+
+/**@brief Sorts an array of longs by sorting narrower offset keys
+   @param data The array to sort
+   @param size The size of the array
+   @param low The smallest value in data, every key is stored as data[i] - low
+   @param engine The sorting engine to run on the narrowed keys
+
+Key must be an unsigned type wide enough to hold the largest offset. The
+arithmetic is done on unsigned long so that the subtraction cannot overflow,
+even when the range spans both negative and positive values.
+*/
+template<class Key, class Engine>
+void narrowSort(long data[], index size, long low, Engine engine) {
+    const unsigned long base = static_cast<unsigned long>(low);
+    Key* keys = new Key[size];
+
+    for (index i = 0; i < size; i++)
+        keys[i] = static_cast<Key>(static_cast<unsigned long>(data[i]) - base);
+
+    engine(keys, size);
+
+    for (index i = 0; i < size; i++)
+        data[i] = static_cast<long>(base + keys[i]);
+    delete [] keys;
+}
+
+/**@brief Picks the narrowest key width for an array, then runs a sort engine
+   @param data The array to sort
+   @param size The size of the array
+   @param narrow false to skip the range scan and sort full-width longs
+   @param engine The sorting engine to run
+
+Halving the key width doubles the number of keys per cache line for the
+comparison sorts, and halves the number of passes for radix sort.
+*/
+template<class Engine>
+void sortKeys(long data[], index size, bool narrow, Engine engine) {
+    if (size <= 1)
+        return;
+
+    if (narrow)
+    {
+        long low, high;
+        keyRange(data, size, low, high);
+        const unsigned long span = static_cast<unsigned long>(high) -
+                                   static_cast<unsigned long>(low);
+
+        if (span <= UINT16_MAX)
+        {
+            narrowSort<uint16_t>(data, size, low, engine);
+            return;
+        }
+        else if (span <= UINT32_MAX)
+        {
+            narrowSort<uint32_t>(data, size, low, engine);
+            return;
+        }
+    }
+    engine(data, size);
+}
+
+//wrappers so that each engine can be passed to sortKeys() as a single object
+struct MergeEngine {
+    template<class Key>
+    void operator()(Key data[], index size) const { mergeSort(data, size); }
+};
+
+struct QuickEngine {
+    template<class Key>
+    void operator()(Key data[], index size) const { quickSort(data, size); }
+};
+
+struct HeapEngine {
+    template<class Key>
+    void operator()(Key data[], index size) const { heapSort(data, size); }
+};
+
+struct RadixEngine {
+    template<class Key>
+    void operator()(Key data[], index size) const { radixSort(data, size); }
+
+    ///radix sort needs unsigned keys, so full-width longs get their sign
+    ///bit flipped, which keeps negative values in front of positive ones
+    void operator()(long data[], index size) const {
+        const uint64_t SIGN = static_cast<uint64_t>(1) << 63;
+        uint64_t* keys = new uint64_t[size];
+        for (index i = 0; i < size; i++)
+            keys[i] = static_cast<uint64_t>(data[i]) ^ SIGN;
+        radixSort(keys, size);
+        for (index i = 0; i < size; i++)
+            data[i] = static_cast<long>(keys[i] ^ SIGN);
+        delete [] keys;
+    }
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 //SORTING ALGORITHMS
 
@@ -127,6 +249,7 @@ void siftDown(long data[], index start, index end) {
    @param data The array to sort
    @param last The ending position in the array (1 + index)
    @param first The starting position in the array
+   @param narrow Sort narrowed keys when the range allows it (default)
 
 Also See mergeData().
 
@@ -152,17 +275,23 @@ Average case: O(n*lg(n))
            result = merge(left, right)
            return result
 */
-void sort::merge(long data[], index last, index first) {
-    const index SIZE = last - first;
+void sort::merge(long data[], index last, index first, bool narrow) {
+    sortKeys(data + first, last - first, narrow, MergeEngine());
+}
+
+///@brief The merge sort engine behind sort::merge(), works on any key width
+template<class Key>
+void mergeSort(Key data[], index size) {
+    const index SIZE = size;
     const index MID = SIZE / 2;
 
     if (SIZE <= 1)
         return;
 
     //create sub-arrays
-    long* left = new long[MID];
+    Key* left = new Key[MID];
     const index right_SIZE = SIZE - MID;
-    long* right = new long[right_SIZE];
+    Key* right = new Key[right_SIZE];
 
     //fill left array
     for (index l = 0; l < MID; l++)
@@ -172,8 +301,8 @@ void sort::merge(long data[], index last, index first) {
         right[r] = data[r + MID];
 
     ///////////////////////////////////////
-    sort::merge(left, MID);
-    sort::merge(right, right_SIZE);
+    mergeSort(left, MID);
+    mergeSort(right, right_SIZE);
     if (left[MID - 1] <= right[0]) // end of left <= beginning of right
     {
         //append right to left
@@ -196,6 +325,7 @@ void sort::merge(long data[], index last, index first) {
 /**@brief Implements recursive quick sort
    @param data The array to sort
    @param size The length of the array
+   @param narrow Sort narrowed keys when the range allows it (default)
 
 Best case: O(n*lg(n))\n
 Worst case: O(n^2)\n
@@ -245,13 +375,19 @@ Average case: O(n*lg(n))
      }
 ~~~~~~~~~~
 */
-void sort::quick(long data[], index size) {
+void sort::quick(long data[], index size, bool narrow) {
+    sortKeys(data, size, narrow, QuickEngine());
+}
+
+///@brief The quick sort engine behind sort::quick(), works on any key width
+template<class Key>
+void quickSort(Key data[], index size) {
     if (size <= 1)
         return;
 
-    long pivot = data[size / 2];
-    long *left = data;
-    long *right = data + size - 1;
+    Key pivot = data[size / 2];
+    Key *left = data;
+    Key *right = data + size - 1;
     while (left <= right)
     {
         //the loop condition must be checked every time either left or right
@@ -267,12 +403,12 @@ void sort::quick(long data[], index size) {
             continue;
         }
 
-        long temp = *left;
+        Key temp = *left;
         *left++ = *right;
         *right-- = temp;
     }
-    sort::quick(data, right - data + 1);
-    sort::quick(left, data + size - left);
+    quickSort(data, right - data + 1);
+    quickSort(left, data + size - left);
 }
 
 
@@ -280,6 +416,7 @@ void sort::quick(long data[], index size) {
           tree
    @param data The array to sort
    @param size The size of the array
+   @param narrow Sort narrowed keys when the range allows it (default)
 
 Also see siftDown().
 
@@ -352,7 +489,13 @@ void heapsort( ValType *a, int count)
 }
 ~~~~~~~~~~
 */
-void sort::heap(long data[], index size) {
+void sort::heap(long data[], index size, bool narrow) {
+    sortKeys(data, size, narrow, HeapEngine());
+}
+
+///@brief The heap sort engine behind sort::heap(), works on any key width
+template<class Key>
+void heapSort(Key data[], index size) {
     //heapify the data
     for (int64_t start = (size - 2) / 2; start >= 0; start--)
         siftDown(data, start, size);
@@ -363,3 +506,67 @@ void sort::heap(long data[], index size) {
         siftDown(data, 0, end);
     }
 }
+
+
+/**@brief Implements LSD (least significant digit) radix sort
+   @param data The array to sort
+   @param size The size of the array
+   @param narrow Sort narrowed keys when the range allows it (default)
+
+Best case: O(n*w)\n
+Worst case: O(n*w)\n
+(w is the number of bytes in a key)
+
+* Does not compare keys at all, keys are distributed into 256 buckets by one
+  byte at a time, starting with the least significant byte
+* Each pass is stable, so the order set by the earlier passes is kept
+* A 16-bit key takes 2 passes, a 32-bit key 4, and a full long 8, which is
+  why this sort benefits the most from key narrowing
+
+    function radixsort(a)
+        for each byte b, least significant first
+            count the keys with each value of b
+            turn the counts into starting positions (prefix sum)
+            move each key to the next position for its value of b
+*/
+void sort::radix(long data[], index size, bool narrow) {
+    sortKeys(data, size, narrow, RadixEngine());
+}
+
+///@brief The radix sort engine behind sort::radix(), Key must be unsigned
+template<class Key>
+void radixSort(Key data[], index size) {
+    Key* buffer = new Key[size];
+    Key* src = data;
+    Key* dest = buffer;
+
+    for (unsigned shift = 0; shift < sizeof(Key) * 8; shift += 8)
+    {
+        index count[256] = {0};
+        for (index i = 0; i < size; i++)
+            count[(src[i] >> shift) & 0xFF]++;
+
+        //every key has the same byte here, the pass would not move anything
+        if (count[(src[0] >> shift) & 0xFF] == size)
+            continue;
+
+        index pos = 0;
+        for (unsigned b = 0; b < 256; b++)
+        {
+            index c = count[b];
+            count[b] = pos;
+            pos += c;
+        }
+
+        for (index i = 0; i < size; i++)
+            dest[count[(src[i] >> shift) & 0xFF]++] = src[i];
+        swap(src, dest);
+    }
+
+    if (src != data)
+    {
+        for (index i = 0; i < size; i++)
+            data[i] = src[i];
+    }
+    delete [] buffer;
+}
@@ -9,11 +9,18 @@
 
 typedef uint32_t index;
 
-///@brief A container for sorting algorithm functions.
+/**@brief A container for sorting algorithm functions.
+
+Every algorithm scans the array once for its smallest and largest value before
+sorting. If the span between them fits in 16 or 32 bits, the keys are narrowed
+to that width (stored as the offset from the smallest value), sorted, and then
+widened back. Pass narrow = false to sort the full-width longs directly.
+*/
 namespace sort {
-    void merge(long data[], index last, index first = 0);
-    void quick(long data[], index size);
-    void heap(long data[], index size);
+    void merge(long data[], index last, index first = 0, bool narrow = true);
+    void quick(long data[], index size, bool narrow = true);
+    void heap(long data[], index size, bool narrow = true);
+    void radix(long data[], index size, bool narrow = true);
 }
 
 #endif // SORT_HH